@@ -0,0 +1,454 @@
+#include "Block.h"
+#include "Lexer.h"
+#include "List.h"
+#include "Parser.h"
+#include "Profiler.h"
+#include "Saver.h"
+#include "StringTable.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Headless benchmark for the editor's core, timing each stage of loading, laying out and saving synthetic Lua programs.
+ * Usage: StructuralEditorBench [--shape wide|deep|table|chain|mixed|all] [--blocks count] [--iterations count]
+ * Results are written to stdout as JSON, all times are in milliseconds.
+ */
+
+static const float BenchFontSize = 16;
+static const int32_t DefaultTargetBlockCount = 100000;
+static const int32_t DefaultIterationCount = 5;
+// Used to estimate how many blocks each unit of a shape generates.
+static const int32_t CalibrationUnitCount = 64;
+
+static const int32_t DeepNestingDepth = 64;
+static const int32_t TableEntryCount = 1024;
+static const int32_t ChainLength = 256;
+
+typedef enum BenchShape
+{
+    BenchShapeWide,
+    BenchShapeDeep,
+    BenchShapeTable,
+    BenchShapeChain,
+    BenchShapeMixed,
+    BenchShapeCount,
+} BenchShape;
+
+static const char *BenchShapeNames[BenchShapeCount] = {
+    [BenchShapeWide] = "wide",
+    [BenchShapeDeep] = "deep",
+    [BenchShapeTable] = "table",
+    [BenchShapeChain] = "chain",
+    [BenchShapeMixed] = "mixed",
+};
+
+typedef enum BenchStage
+{
+    BenchStageLex,
+    BenchStageLexScalar,
+    BenchStageLexStream,
+    BenchStageParse,
+    BenchStageUpdateTree,
+    BenchStageCopy,
+    BenchStageDelete,
+    BenchStageReclaim,
+    BenchStageSave,
+    BenchStageArenaDelete,
+    BenchStageCount,
+} BenchStage;
+
+static const char *BenchStageNames[BenchStageCount] = {
+    [BenchStageLex] = "lex",
+    [BenchStageLexScalar] = "lexScalar",
+    [BenchStageLexStream] = "lexStream",
+    [BenchStageParse] = "parse",
+    [BenchStageUpdateTree] = "updateTree",
+    [BenchStageCopy] = "copy",
+    [BenchStageDelete] = "delete",
+    [BenchStageReclaim] = "reclaim",
+    [BenchStageSave] = "save",
+    [BenchStageArenaDelete] = "arenaDelete",
+};
+
+typedef struct BenchTiming
+{
+    double min;
+    double total;
+} BenchTiming;
+
+// Streams the generated text to the lexer, as if it was being read from a file.
+typedef struct BenchReader
+{
+    List_char *text;
+    int32_t position;
+} BenchReader;
+
+static void BenchWrite(List_char *text, const char *format, ...)
+{
+    char buffer[256];
+
+    va_list arguments;
+    va_start(arguments, format);
+    int32_t length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+
+    assert(length >= 0 && length < (int32_t)sizeof(buffer));
+
+    for (int32_t i = 0; i < length; i++)
+    {
+        ListPush_char(text, buffer[i]);
+    }
+}
+
+// A long list of small statements.
+static void BenchGenerateWide(List_char *text, int32_t unitI)
+{
+    BenchWrite(text, "local value%d = %d\n", unitI, unitI);
+    BenchWrite(text, "print(value%d, \"wide\")\n", unitI);
+}
+
+// Statements nested inside of each other.
+static void BenchGenerateDeep(List_char *text, int32_t unitI)
+{
+    for (int32_t i = 0; i < DeepNestingDepth; i++)
+    {
+        BenchWrite(text, "if depth%d > %d then\n", i, unitI);
+    }
+
+    BenchWrite(text, "count = count + 1\n");
+
+    for (int32_t i = 0; i < DeepNestingDepth; i++)
+    {
+        BenchWrite(text, "end\n");
+    }
+}
+
+// One huge table literal, mixing all three kinds of entries.
+static void BenchGenerateTable(List_char *text, int32_t unitI)
+{
+    BenchWrite(text, "local table%d = {\n", unitI);
+
+    for (int32_t i = 0; i < TableEntryCount; i++)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            BenchWrite(text, "key%d = %d,\n", i, i);
+            break;
+        case 1:
+            BenchWrite(text, "[\"key%d\"] = \"value\",\n", i);
+            break;
+        case 2:
+            BenchWrite(text, "%d,\n", i);
+            break;
+        }
+    }
+
+    BenchWrite(text, "}\n");
+}
+
+// One expression with a long chain of operators.
+static void BenchGenerateChain(List_char *text, int32_t unitI)
+{
+    static const char *operators[] = {"+", "-", "*", "/", "..", "and", "or", "=="};
+    const int32_t operatorCount = sizeof(operators) / sizeof(operators[0]);
+
+    BenchWrite(text, "result%d = term0", unitI);
+
+    for (int32_t i = 1; i < ChainLength; i++)
+    {
+        BenchWrite(text, " %s term%d", operators[i % operatorCount], i);
+    }
+
+    BenchWrite(text, "\n");
+}
+
+// A function resembling handwritten code.
+static void BenchGenerateMixed(List_char *text, int32_t unitI)
+{
+    BenchWrite(text, "local function update%d(self, delta, other)\n", unitI);
+    BenchWrite(text, "local speed = self.speed * delta + 2\n");
+    BenchWrite(text, "if speed > 10 then\n");
+    BenchWrite(text, "self.velocity = self.velocity - speed\n");
+    BenchWrite(text, "elseif speed == 0 then\n");
+    BenchWrite(text, "return other .. \"stopped\"\n");
+    BenchWrite(text, "else\n");
+    BenchWrite(text, "self.active = not self.active\n");
+    BenchWrite(text, "end\n");
+    BenchWrite(text, "for i = 1, 10 do\n");
+    BenchWrite(text, "print(i, self.name)\n");
+    BenchWrite(text, "end\n");
+    BenchWrite(text, "for key in pairs(self.items) do\n");
+    BenchWrite(text, "self.items[key] = {count = 1, [\"name\"] = key, 3}\n");
+    BenchWrite(text, "end\n");
+    BenchWrite(text, "while speed < 10 do speed = speed + 1 end\n");
+    BenchWrite(text, "-- a comment about update%d\n", unitI);
+    BenchWrite(text, "return speed, #self.items\n");
+    BenchWrite(text, "end\n");
+}
+
+static void BenchGenerate(List_char *text, BenchShape shape, int32_t unitCount)
+{
+    ListReset_char(text);
+    BenchWrite(text, "do\n");
+
+    for (int32_t i = 0; i < unitCount; i++)
+    {
+        switch (shape)
+        {
+        case BenchShapeWide:
+            BenchGenerateWide(text, i);
+            break;
+        case BenchShapeDeep:
+            BenchGenerateDeep(text, i);
+            break;
+        case BenchShapeTable:
+            BenchGenerateTable(text, i);
+            break;
+        case BenchShapeChain:
+            BenchGenerateChain(text, i);
+            break;
+        case BenchShapeMixed:
+            BenchGenerateMixed(text, i);
+            break;
+        default:
+            break;
+        }
+    }
+
+    BenchWrite(text, "end\n");
+}
+
+static int32_t BenchRead(void *user, char *buffer, int32_t count)
+{
+    BenchReader *reader = user;
+    int32_t readCount = reader->text->count - reader->position;
+
+    if (readCount > count)
+    {
+        readCount = count;
+    }
+
+    memcpy(buffer, reader->text->data + reader->position, readCount);
+    reader->position += readCount;
+
+    return readCount;
+}
+
+static Block *BenchParse(List_char *text, BlockArena *arena)
+{
+    Parser parser = ParserNew(LexerNew(text->data, text->count), arena);
+    Block *rootBlock = ParserParseStatement(&parser, NULL, 0);
+    ParserDelete(&parser);
+
+    return rootBlock;
+}
+
+static int32_t BenchGetUnitCount(List_char *text, BenchShape shape, int32_t targetBlockCount)
+{
+    BenchGenerate(text, shape, CalibrationUnitCount);
+
+    BlockArena arena = BlockArenaNew();
+    uint64_t calibrationBlockCount = BlockCountAll(BenchParse(text, &arena));
+    BlockArenaDelete(&arena);
+
+    double blocksPerUnit = (double)calibrationBlockCount / CalibrationUnitCount;
+    int32_t unitCount = (int32_t)(targetBlockCount / blocksPerUnit + 0.5);
+
+    return unitCount < 1 ? 1 : unitCount;
+}
+
+static void BenchRecord(BenchTiming *timing, double startTime)
+{
+    double time = (ProfilerGetTime() - startTime) * 1000.0;
+
+    timing->total += time;
+
+    if (time < timing->min)
+    {
+        timing->min = time;
+    }
+}
+
+static void BenchRunShape(
+    List_char *text, BenchShape shape, int32_t targetBlockCount, int32_t iterationCount, bool isLast)
+{
+    int32_t unitCount = BenchGetUnitCount(text, shape, targetBlockCount);
+    BenchGenerate(text, shape, unitCount);
+
+    BenchTiming timings[BenchStageCount];
+
+    for (int32_t i = 0; i < BenchStageCount; i++)
+    {
+        timings[i] = (BenchTiming){
+            .min = INFINITY,
+        };
+    }
+
+    uint64_t blockCount = 0;
+    Saver saver = SaverNew();
+
+    for (int32_t iterationI = 0; iterationI < iterationCount; iterationI++)
+    {
+        double startTime = ProfilerGetTime();
+        Lexer lexer = LexerNew(text->data, text->count);
+
+        while (LexerPeek(&lexer).start < text->count)
+        {
+            LexerNext(&lexer);
+        }
+
+        LexerDelete(&lexer);
+        BenchRecord(&timings[BenchStageLex], startTime);
+
+        LexerSetVectorized(false);
+        startTime = ProfilerGetTime();
+        Lexer scalarLexer = LexerNew(text->data, text->count);
+
+        while (LexerPeek(&scalarLexer).start < text->count)
+        {
+            LexerNext(&scalarLexer);
+        }
+
+        LexerDelete(&scalarLexer);
+        BenchRecord(&timings[BenchStageLexScalar], startTime);
+        LexerSetVectorized(true);
+
+        startTime = ProfilerGetTime();
+        BenchReader reader = (BenchReader){
+            .text = text,
+        };
+        Lexer streamLexer = LexerNewStream(BenchRead, &reader);
+
+        while (LexerPeek(&streamLexer).start < text->count)
+        {
+            LexerNext(&streamLexer);
+        }
+
+        LexerDelete(&streamLexer);
+        BenchRecord(&timings[BenchStageLexStream], startTime);
+
+        BlockArena arena = BlockArenaNew();
+
+        startTime = ProfilerGetTime();
+        Block *rootBlock = BenchParse(text, &arena);
+        BenchRecord(&timings[BenchStageParse], startTime);
+
+        startTime = ProfilerGetTime();
+        BlockUpdateTree(rootBlock);
+        BenchRecord(&timings[BenchStageUpdateTree], startTime);
+
+        startTime = ProfilerGetTime();
+        Block *copyBlock = BlockCopy(&arena, rootBlock, NULL, 0);
+        BenchRecord(&timings[BenchStageCopy], startTime);
+
+        // Deleting only queues the copy to be taken apart later, the work of freeing it is timed separately.
+        startTime = ProfilerGetTime();
+        BlockDelete(copyBlock);
+        BenchRecord(&timings[BenchStageDelete], startTime);
+
+        startTime = ProfilerGetTime();
+        BlockArenaReclaimDeletedBlocks(&arena);
+        BenchRecord(&timings[BenchStageReclaim], startTime);
+
+        startTime = ProfilerGetTime();
+        SaverReset(&saver);
+        SaverSave(&saver, rootBlock);
+        BenchRecord(&timings[BenchStageSave], startTime);
+
+        blockCount = BlockCountAll(rootBlock);
+
+        startTime = ProfilerGetTime();
+        BlockArenaDelete(&arena);
+        BenchRecord(&timings[BenchStageArenaDelete], startTime);
+    }
+
+    SaverDelete(&saver);
+
+    printf("    {\n");
+    printf("      \"shape\": \"%s\",\n", BenchShapeNames[shape]);
+    printf("      \"units\": %d,\n", unitCount);
+    printf("      \"blocks\": %llu,\n", (unsigned long long)blockCount);
+    printf("      \"bytes\": %d,\n", text->count);
+    printf("      \"uniqueIdentifiers\": %d,\n", StringTableGetCount());
+    printf("      \"timings\": {\n");
+
+    for (int32_t i = 0; i < BenchStageCount; i++)
+    {
+        printf("        \"%s\": {\"min\": %.4f, \"average\": %.4f}%s\n", BenchStageNames[i], timings[i].min,
+            timings[i].total / iterationCount, i < BenchStageCount - 1 ? "," : "");
+    }
+
+    printf("      }\n");
+    printf("    }%s\n", isLast ? "" : ",");
+    fflush(stdout);
+}
+
+int main(int argumentCount, char **arguments)
+{
+    int32_t targetBlockCount = DefaultTargetBlockCount;
+    int32_t iterationCount = DefaultIterationCount;
+    int32_t shapeI = -1;
+
+    for (int32_t i = 1; i < argumentCount - 1; i += 2)
+    {
+        if (strcmp(arguments[i], "--blocks") == 0)
+        {
+            targetBlockCount = atoi(arguments[i + 1]);
+        }
+        else if (strcmp(arguments[i], "--iterations") == 0)
+        {
+            iterationCount = atoi(arguments[i + 1]);
+        }
+        else if (strcmp(arguments[i], "--shape") == 0)
+        {
+            for (int32_t j = 0; j < BenchShapeCount; j++)
+            {
+                if (strcmp(arguments[i + 1], BenchShapeNames[j]) == 0)
+                {
+                    shapeI = j;
+                }
+            }
+        }
+    }
+
+    if (iterationCount < 1)
+    {
+        iterationCount = 1;
+    }
+
+    Font *font = FontNew("Bench", NULL, 0, BenchFontSize);
+
+    BlockKindsInit();
+    BlockKindsUpdateTextSize(font);
+    StringTableInit();
+
+    List_char text = ListNew_char(1024);
+
+    printf("{\n");
+    printf("  \"targetBlocks\": %d,\n", targetBlockCount);
+    printf("  \"iterations\": %d,\n", iterationCount);
+    printf("  \"results\": [\n");
+
+    int32_t firstShape = shapeI < 0 ? 0 : shapeI;
+    int32_t lastShape = shapeI < 0 ? BenchShapeCount - 1 : shapeI;
+
+    for (int32_t i = firstShape; i <= lastShape; i++)
+    {
+        BenchRunShape(&text, i, targetBlockCount, iterationCount, i == lastShape);
+    }
+
+    printf("  ]\n");
+    printf("}\n");
+
+    ListDelete_char(&text);
+    StringTableDeinit();
+    BlockKindsDeinit();
+    FontDelete(font);
+
+    return 0;
+}
\ No newline at end of file
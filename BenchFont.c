@@ -0,0 +1,120 @@
+#include "Font.h"
+#include "Profiler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Stands in for Font.c in the benchmark, which runs without a window or GPU.
+// Every character is given the same advance, so measuring text stays cheap and deterministic.
+typedef struct FontMetrics
+{
+    float size;
+} FontMetrics;
+
+typedef struct Font
+{
+    FontMetrics metrics;
+} Font;
+
+static const float BenchFontAdvance = 0.6f;
+static const float BenchFontLineHeight = 1.2f;
+
+Font *FontNew(const char *name, uint8_t *data, int32_t dataSize, float size)
+{
+    (void)name, (void)data, (void)dataSize;
+
+    Font *font = malloc(sizeof(Font));
+    *font = (Font){
+        .metrics.size = size,
+    };
+
+    return font;
+}
+
+int32_t FontDelete(Font *font)
+{
+    free(font);
+
+    return 0;
+}
+
+void FontUpdate(Font *font)
+{
+    (void)font;
+}
+
+void FontFlush(Font *font)
+{
+    (void)font;
+}
+
+float FontGetSize(Font *font)
+{
+    return font->metrics.size;
+}
+
+const FontMetrics *FontGetMetrics(Font *font)
+{
+    return &font->metrics;
+}
+
+void FontSetDrawScale(Font *font, float drawScale)
+{
+    (void)font, (void)drawScale;
+}
+
+int32_t FontDraw(const char *text, float x, float y, Font *font)
+{
+    (void)text, (void)x, (void)y, (void)font;
+
+    return 0;
+}
+
+// Nothing is drawn, but glyphs are still counted so that tests can see which text would have been.
+int32_t FontDrawSpan(const char *text, int32_t textLength, float x, float y, Font *font)
+{
+    (void)text, (void)x, (void)y, (void)font;
+
+    ProfilerCount(ProfilerCounterGlyphsDrawn, textLength);
+
+    return 0;
+}
+
+float FontMetricsGetSize(const FontMetrics *metrics)
+{
+    return metrics->size;
+}
+
+void FontMetricsGetTextSize(const FontMetrics *metrics, const char *text, int32_t textLength, int32_t *width,
+    int32_t *height, int32_t *ascent, int32_t *descent)
+{
+    (void)text;
+
+    if (width)
+    {
+        *width = (int32_t)(textLength * metrics->size * BenchFontAdvance);
+    }
+
+    if (height)
+    {
+        *height = (int32_t)(metrics->size * BenchFontLineHeight);
+    }
+
+    if (ascent)
+    {
+        *ascent = (int32_t)metrics->size;
+    }
+
+    if (descent)
+    {
+        *descent = (int32_t)(metrics->size * (1.0f - BenchFontLineHeight));
+    }
+}
+
+int32_t FontGetTextSize(
+    const char *text, int32_t *width, int32_t *height, int32_t *ascent, int32_t *descent, Font *font)
+{
+    FontMetricsGetTextSize(&font->metrics, text, (int32_t)strlen(text), width, height, ascent, descent);
+
+    return 0;
+}
\ No newline at end of file
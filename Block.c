@@ -1,6 +1,6 @@
 #include "Block.h"
 #include "Math.h"
-#include "Shapes.h"
+#include "Tracer.h"
 
 #define _CRTDBG_MAP_ALLOC
 #include <crtdbg.h>
@@ -36,6 +36,7 @@ BlockKind BlockKindNew(BlockKind blockKind)
     }
 
     blockKind.defaultChildren = defaultChildren;
+    blockKind.textLength = blockKind.text ? (int32_t)strlen(blockKind.text) : 0;
 
     return blockKind;
 }
@@ -129,6 +130,8 @@ const PinKindValidBlockSet PinKindValidBlocks[] = {
 };
 
 BlockKind BlockKinds[BlockKindIdCount];
+// Identifiers are measured with the same font as block kinds, the first time they're laid out.
+static InternedStringSizes BlockIdentifierSizes;
 
 void BlockKindsInit(void)
 {
@@ -646,10 +649,15 @@ void BlockKindsDeinit(void)
     {
         free(BlockKinds[i].defaultChildren);
     }
+
+    InternedStringSizesDelete(&BlockIdentifierSizes);
 }
 
 void BlockKindsUpdateTextSize(Font *font)
 {
+    InternedStringSizesDelete(&BlockIdentifierSizes);
+    BlockIdentifierSizes = InternedStringSizesNew(FontGetMetrics(font));
+
     for (int32_t i = 0; i < BlockKindIdCount; i++)
     {
         if (BlockKinds[i].text)
@@ -658,32 +666,32 @@ void BlockKindsUpdateTextSize(Font *font)
         }
     }
 }
-
 // TODO: Have a way to create a block without creating it's children,
 // this could be used in the parser when we know we're going to
 // overwrite the new block's children anyway.
-Block *BlockNew(BlockKindId kindId, Block *parent, int32_t childI)
+Block *BlockNew(BlockArena *arena, BlockKindId kindId, Block *parent, int32_t childI)
 {
     const BlockKind *kind = &BlockKinds[kindId];
+    BlockStore *store = &arena->store;
 
-    Block *block = malloc(sizeof(Block));
+    Block *block = BlockArenaAllocateBlock(arena);
     assert(block);
 
     *block = (Block){
         .kindId = kindId,
         .parent = parent,
+        .arena = arena,
         .childI = childI,
-        .y = INT32_MAX,
     };
 
+    block->id = BlockStoreAdd(store, block, (uint8_t)kindId);
+
     if (kindId == BlockKindIdIdentifier)
     {
         return block;
     }
 
-    block->data.parent = (BlockParentData){
-        .children = ListNew_BlockPointer(kind->defaultChildrenCount),
-    };
+    BlockStoreReserveChildren(store, block->id, kind->defaultChildrenCount);
 
     for (int32_t i = 0; i < kind->defaultChildrenCount; i++)
     {
@@ -693,96 +701,80 @@ Block *BlockNew(BlockKindId kindId, Block *parent, int32_t childI)
             continue;
         }
 
+        Block *child = NULL;
+
         if (kind->defaultChildren[i].isPin)
         {
-            ListPush_BlockPointer(&block->data.parent.children, BlockNew(BlockKindIdPin, block, i));
+            child = BlockNew(arena, BlockKindIdPin, block, i);
         }
         else
         {
-            ListPush_BlockPointer(
-                &block->data.parent.children, BlockNew(kind->defaultChildren[i].blockKindId, block, i));
+            child = BlockNew(arena, kind->defaultChildren[i].blockKindId, block, i);
         }
+
+        BlockStoreSetChild(store, block->id, i, child->id);
     }
 
     return block;
 }
 
-Block *BlockNewIdentifier(char *text, int32_t textCount, Font *font, Block *parent, int32_t childI)
+// Identifiers aren't measured until they're laid out, so blocks that are created but never laid out,
+// such as while loading a file, don't pay for it.
+Block *BlockNewIdentifier(BlockArena *arena, char *text, int32_t textCount, Block *parent, int32_t childI)
 {
-    Block *block = BlockNew(BlockKindIdIdentifier, parent, childI);
-    BlockIdentifierData *identifierData = &block->data.identifier;
-
-    identifierData->text = malloc(textCount + 1);
-    strncpy(identifierData->text, text, textCount);
-    identifierData->text[textCount] = '\0';
+    Block *block = BlockNew(arena, BlockKindIdIdentifier, parent, childI);
 
-    FontGetTextSize(identifierData->text, &identifierData->textWidth, &identifierData->textHeight, NULL, NULL, font);
+    block->identifier = StringTableIntern(text, textCount);
 
     return block;
 }
 
-Block *BlockCopy(Block *other, Block *parent, int32_t childI)
+Block *BlockCopy(BlockArena *arena, Block *other, Block *parent, int32_t childI)
 {
-    Block *block = malloc(sizeof(Block));
+    BlockStore *store = &arena->store;
+
+    Block *block = BlockArenaAllocateBlock(arena);
     assert(block);
 
     *block = *other;
     block->parent = parent;
+    block->arena = arena;
     block->childI = childI;
+    block->id = BlockStoreAdd(store, block, (uint8_t)other->kindId);
 
     if (other->kindId == BlockKindIdIdentifier)
     {
-        int32_t textLength = (int32_t)strlen(other->data.identifier.text);
-        block->data.identifier.text = calloc(textLength + 1, sizeof(char));
-        memcpy(block->data.identifier.text, other->data.identifier.text, textLength);
-
         return block;
     }
 
-    BlockParentData *parentData = &block->data.parent;
-    BlockParentData *otherParentData = &other->data.parent;
+    int32_t childrenCount = BlockGetChildrenCount(other);
+    BlockStoreReserveChildren(store, block->id, childrenCount);
 
-    parentData->children = ListNew_BlockPointer(otherParentData->children.count);
-
-    for (int32_t i = 0; i < otherParentData->children.count; i++)
+    for (int32_t i = 0; i < childrenCount; i++)
     {
-        ListPush_BlockPointer(&parentData->children, BlockCopy(otherParentData->children.data[i], block, i));
+        Block *child = BlockCopy(arena, BlockGetChild(other, i), block, i);
+        BlockStoreSetChild(store, block->id, i, child->id);
     }
 
     return block;
 }
 
+// Deleting is O(1), the block's subtree is reclaimed lazily by it's arena as new blocks are allocated.
 void BlockDelete(Block *block)
 {
-    if (block->kindId == BlockKindIdIdentifier)
-    {
-        free(block->data.identifier.text);
-    }
-    else
-    {
-        for (int32_t i = 0; i < block->data.parent.children.count; i++)
-        {
-            Block *child = BlockGetChild(block, i);
-
-            BlockDelete(child);
-        }
-
-        ListDelete_BlockPointer(&block->data.parent.children);
-    }
-
-    free(block);
+    BlockArenaFreeBlock(block->arena, block);
 }
 
+// Only the path from the block to the root is revisited by the next update,
+// along with the path to the block's leaf in each ancestor's extent tree.
 void BlockMarkNeedsUpdate(Block *block)
 {
-    block->y = INT32_MAX;
-
-    Block *parent = block->parent;
+    BlockStore *store = &block->arena->store;
+    store->layouts.data[block->id].needsUpdate = true;
 
-    while (parent && parent->y != INT32_MAX)
+    for (; block->parent; block = block->parent)
     {
-        parent->y = INT32_MAX;
-        parent = parent->parent;
+        BlockStoreMarkChildNeedsUpdate(store, block->parent->id, block->childI);
     }
 }
 
@@ -805,21 +797,20 @@ bool BlockContainsNonPin(Block *block)
 
 int32_t BlockGetChildrenCount(Block *block)
 {
-    if (block->kindId == BlockKindIdIdentifier)
-    {
-        return 0;
-    }
-
-    return block->data.parent.children.count;
+    return BlockStoreGetChildrenCount(&block->arena->store, block->id);
 }
 
-char *BlockGetText(Block *block)
+// Identifier text isn't always null terminated, so it's length is returned too.
+char *BlockGetText(Block *block, int32_t *textLength)
 {
     if (block->kindId == BlockKindIdIdentifier)
     {
-        return block->data.identifier.text;
+        *textLength = block->identifier->textLength;
+        return block->identifier->text;
     }
 
+    *textLength = BlockKinds[block->kindId].textLength;
+
     return BlockKinds[block->kindId].text;
 }
 
@@ -827,8 +818,7 @@ void BlockGetTextSize(Block *block, int32_t *width, int32_t *height)
 {
     if (block->kindId == BlockKindIdIdentifier)
     {
-        *width = block->data.identifier.textWidth;
-        *height = block->data.identifier.textHeight;
+        InternedStringMeasure(&BlockIdentifierSizes, block->identifier, width, height);
         return;
     }
 
@@ -836,6 +826,32 @@ void BlockGetTextSize(Block *block, int32_t *width, int32_t *height)
     *height = BlockKinds[block->kindId].textHeight;
 }
 
+void BlockGetSize(Block *block, int32_t *width, int32_t *height)
+{
+    BlockLayout *layout = &block->arena->store.layouts.data[block->id];
+
+    *width = layout->width;
+    *height = layout->height;
+}
+
+// Where a block's children start horizontally, relative to the block's position.
+int32_t BlockGetChildrenStartX(BlockKindId kindId, int32_t textWidth)
+{
+    int32_t startX = BlockPaddingX;
+
+    if (!BlockKinds[kindId].isTextInfix)
+    {
+        startX += textWidth;
+
+        if (textWidth != 0)
+        {
+            startX += BlockPaddingX;
+        }
+    }
+
+    return startX;
+}
+
 DefaultChildKind *BlockGetDefaultChildKind(Block *block, int32_t childI)
 {
     const BlockKind *kind = &BlockKinds[block->kindId];
@@ -846,22 +862,34 @@ DefaultChildKind *BlockGetDefaultChildKind(Block *block, int32_t childI)
 
 Block *BlockGetChild(Block *block, int32_t childI)
 {
-    return block->data.parent.children.data[childI];
+    BlockStore *store = &block->arena->store;
+
+    return store->blocks.data[BlockStoreGetChild(store, block->id, childI)];
 }
 
 void BlockGetGlobalPosition(Block *block, int32_t *x, int32_t *y)
 {
-    *x = block->x;
-    *y = block->y;
+    BlockStore *store = &block->arena->store;
 
-    Block *parent = block->parent;
+    *x = 0;
+    *y = 0;
 
-    while (parent)
+    for (; block->parent; block = block->parent)
     {
-        *x += parent->x;
-        *y += parent->y;
+        Block *parent = block->parent;
+        int32_t startX = BlockGetChildrenStartX(parent->kindId, BlockKinds[parent->kindId].textWidth);
+        int32_t offset = BlockStoreGetChildOffset(store, parent->id, block->childI);
 
-        parent = parent->parent;
+        if (BlockKinds[parent->kindId].isVertical)
+        {
+            *x += startX;
+            *y += BlockPaddingY + offset;
+        }
+        else
+        {
+            *x += startX + offset;
+            *y += BlockPaddingY;
+        }
     }
 }
 
@@ -930,21 +958,25 @@ Block *BlockReplaceChild(Block *block, Block *child, int32_t childI, bool doDele
 {
     assert(block->kindId != BlockKindIdIdentifier);
 
-    BlockParentData *parentData = &block->data.parent;
-    Block *oldChild = parentData->children.data[childI];
+    int32_t childrenCount = BlockGetChildrenCount(block);
+    Block *oldChild = NULL;
 
-    if (childI >= parentData->children.count)
+    if (childI >= childrenCount)
     {
-        childI = parentData->children.count;
-        ListPush_BlockPointer(&parentData->children, (BlockPointer){0});
+        childI = childrenCount;
     }
-    else if (doDelete)
+    else
     {
-        BlockDelete(oldChild);
-        oldChild = NULL;
+        oldChild = BlockGetChild(block, childI);
+
+        if (doDelete)
+        {
+            BlockDelete(oldChild);
+            oldChild = NULL;
+        }
     }
 
-    parentData->children.data[childI] = child;
+    BlockStoreSetChild(&block->arena->store, block->id, childI, child->id);
     child->parent = block;
     child->childI = childI;
 
@@ -955,16 +987,16 @@ void BlockInsertChild(Block *block, Block *child, int32_t childI)
 {
     assert(block->kindId != BlockKindIdIdentifier);
 
-    BlockParentData *parentData = &block->data.parent;
+    int32_t childrenCount = BlockGetChildrenCount(block);
 
-    for (int32_t i = childI; i < parentData->children.count; i++)
+    for (int32_t i = childI; i < childrenCount; i++)
     {
-        parentData->children.data[i]->childI += 1;
+        BlockGetChild(block, i)->childI += 1;
     }
 
     child->parent = block;
     child->childI = childI;
-    ListInsert_BlockPointer(&parentData->children, child, childI);
+    BlockStoreInsertChild(&block->arena->store, block->id, childI, child->id);
 }
 
 // Returns a BlockDeleteResult, which will contain the previous child if doDelete is false.
@@ -972,8 +1004,7 @@ void BlockInsertChild(Block *block, Block *child, int32_t childI)
 BlockDeleteResult BlockDeleteChild(Block *block, int32_t childI, bool doDelete)
 {
     BlockKind *kind = &BlockKinds[block->kindId];
-    BlockParentData *parentData = &block->data.parent;
-    Block *oldChild = parentData->children.data[childI];
+    Block *oldChild = BlockGetChild(block, childI);
 
     if (kind->isGrowable && childI != 0 && childI >= kind->defaultChildrenCount - 1)
     {
@@ -984,11 +1015,13 @@ BlockDeleteResult BlockDeleteChild(Block *block, int32_t childI, bool doDelete)
             oldChild = NULL;
         }
 
-        ListRemove_BlockPointer(&parentData->children, childI);
+        BlockStoreRemoveChild(&block->arena->store, block->id, childI);
 
-        for (int32_t i = childI; i < parentData->children.count; i++)
+        int32_t childrenCount = BlockGetChildrenCount(block);
+
+        for (int32_t i = childI; i < childrenCount; i++)
         {
-            parentData->children.data[i]->childI -= 1;
+            BlockGetChild(block, i)->childI -= 1;
         }
 
         return (BlockDeleteResult){
@@ -1001,7 +1034,7 @@ BlockDeleteResult BlockDeleteChild(Block *block, int32_t childI, bool doDelete)
     // it's default value instead of deleting it.
     DefaultChildKind *defaultKind = BlockGetDefaultChildKind(block, childI);
 
-    Block *defaultBlock = BlockNew(defaultKind->blockKindId, block, childI);
+    Block *defaultBlock = BlockNew(block->arena, defaultKind->blockKindId, block, childI);
     BlockReplaceChild(block, defaultBlock, childI, doDelete);
 
     return (BlockDeleteResult){
@@ -1012,9 +1045,8 @@ BlockDeleteResult BlockDeleteChild(Block *block, int32_t childI, bool doDelete)
 
 void BlockSwapChildren(Block *block, int32_t firstChildI, int32_t secondChildI)
 {
-    BlockParentData *parentData = &block->data.parent;
-    Block *firstChild = parentData->children.data[firstChildI];
-    Block *secondChild = parentData->children.data[secondChildI];
+    Block *firstChild = BlockGetChild(block, firstChildI);
+    Block *secondChild = BlockGetChild(block, secondChildI);
 
     if (!BlockCanSwapWith(firstChild, secondChild))
     {
@@ -1024,215 +1056,211 @@ void BlockSwapChildren(Block *block, int32_t firstChildI, int32_t secondChildI)
     firstChild->childI = secondChildI;
     secondChild->childI = firstChildI;
 
-    parentData->children.data[firstChildI] = secondChild;
-    parentData->children.data[secondChildI] = firstChild;
+    BlockStoreSwapChildren(&block->arena->store, block->id, firstChildI, secondChildI);
 }
 
-uint64_t BlockCountAll(Block *block)
+static uint64_t BlockCountAllById(BlockStore *store, BlockId id)
 {
     uint64_t count = 1;
+    BlockChildRange range = store->childRanges.data[id];
 
-    for (int32_t i = 0; i < BlockGetChildrenCount(block); i++)
+    for (int32_t i = 0; i < range.count; i++)
     {
-        Block *child = BlockGetChild(block, i);
-
-        count += BlockCountAll(child);
+        count += BlockCountAllById(store, store->childIds.data[range.start + i]);
     }
 
     return count;
 }
 
-void BlockUpdateTree(Block *block, int32_t x, int32_t y)
+uint64_t BlockCountAll(Block *block)
 {
-    bool needsUpdate = block->y == INT32_MAX;
+    return BlockCountAllById(&block->arena->store, block->id);
+}
 
-    block->x = x;
-    block->y = y;
+static void BlockGetTextSizeById(BlockStore *store, BlockId id, int32_t *width, int32_t *height)
+{
+    BlockKindId kindId = store->kindIds.data[id];
 
-    if (!needsUpdate)
+    if (kindId == BlockKindIdIdentifier)
     {
+        BlockGetTextSize(store->blocks.data[id], width, height);
         return;
     }
 
-    int32_t textWidth, textHeight;
-    BlockGetTextSize(block, &textWidth, &textHeight);
-
-    int32_t childrenCount = BlockGetChildrenCount(block);
-
-    int32_t localX = 0;
-    int32_t localY = 0;
+    *width = BlockKinds[kindId].textWidth;
+    *height = BlockKinds[kindId].textHeight;
+}
 
-    localX += BlockPaddingX;
+// Children of vertical blocks are stacked downwards, otherwise they're placed in a row,
+// with infix blocks leaving space for their text between each child.
+static BlockLayoutNode BlockGetLayoutLeaf(BlockStore *store, const BlockKind *kind, BlockId childId)
+{
+    BlockLayout *childLayout = &store->layouts.data[childId];
 
-    if (childrenCount > 0)
-    {
-        localY += BlockPaddingY;
-    }
-    else
+    if (kind->isVertical)
     {
-        localY += textHeight;
+        return (BlockLayoutNode){
+            .mainExtent = childLayout->height + BlockPaddingY,
+            .crossExtent = childLayout->width,
+        };
     }
 
-    const BlockKind *kind = &BlockKinds[block->kindId];
-
-    if (!kind->isTextInfix)
-    {
-        localX += textWidth;
+    int32_t infixWidth = kind->isTextInfix ? kind->textWidth + BlockPaddingX : 0;
 
-        if (textWidth != 0)
-        {
-            localX += BlockPaddingX;
-        }
-    }
-
-    int32_t startX = localX;
-    int32_t maxWidth = 0;
+    return (BlockLayoutNode){
+        .mainExtent = childLayout->width + BlockPaddingX + infixWidth,
+        .crossExtent = childLayout->height,
+    };
+}
 
-    if (kind->isVertical)
-    {
-        for (int32_t i = 0; i < childrenCount; i++)
-        {
-            Block *child = BlockGetChild(block, i);
+static void BlockCombineLayoutNodes(BlockLayoutNode *nodes, int32_t nodeI)
+{
+    BlockLayoutNode *left = &nodes[nodeI * 2];
+    BlockLayoutNode *right = &nodes[nodeI * 2 + 1];
 
-            BlockUpdateTree(child, localX, localY);
+    nodes[nodeI] = (BlockLayoutNode){
+        .mainExtent = left->mainExtent + right->mainExtent,
+        .crossExtent = MathInt32Max(left->crossExtent, right->crossExtent),
+        .hasMeshDirtyChild = left->hasMeshDirtyChild || right->hasMeshDirtyChild,
+    };
+}
 
-            localX += child->width + BlockPaddingX;
-            localY += child->height + BlockPaddingY;
+// Children after one whose main extent changed have moved, so their geometry needs to be rewritten too.
+static void BlockUpdateLayoutLeaf(BlockStore *store, BlockLayout *layout, const BlockKind *kind, BlockLayoutNode *leaf,
+    int32_t childI, BlockId childId)
+{
+    BlockLayoutNode newLeaf = BlockGetLayoutLeaf(store, kind, childId);
 
-            maxWidth = MathInt32Max(maxWidth, localX);
-            localX = startX;
-        }
-    }
-    else
+    if (newLeaf.mainExtent != leaf->mainExtent)
     {
-        int32_t maxHeight = 0;
-
-        for (int32_t i = 0; i < childrenCount; i++)
-        {
-            Block *child = BlockGetChild(block, i);
+        layout->firstMovedChildI = MathInt32Min(layout->firstMovedChildI, childI + 1);
+    }
 
-            BlockUpdateTree(child, localX, localY);
+    newLeaf.hasMeshDirtyChild = store->layouts.data[childId].needsMeshUpdate;
+    *leaf = newLeaf;
+}
 
-            localX += child->width + BlockPaddingX;
+static void BlockUpdateLayoutById(BlockStore *store, BlockId id);
 
-            if (i < childrenCount - 1 && kind->isTextInfix)
-            {
-                localX += textWidth + BlockPaddingX;
-            }
+// Only descends into nodes with a dirty child, so a single change costs O(log n) in it's parent's tree.
+static void BlockUpdateLayoutNode(BlockStore *store, BlockLayout *layout, const BlockKind *kind, BlockChildRange range,
+    BlockLayoutNode *nodes, int32_t nodeI)
+{
+    if (nodeI >= range.capacity)
+    {
+        int32_t childI = nodeI - range.capacity;
+        BlockId childId = store->childIds.data[range.start + childI];
 
-            maxHeight = MathInt32Max(maxHeight, child->height + BlockPaddingY);
-        }
+        BlockUpdateLayoutById(store, childId);
+        BlockUpdateLayoutLeaf(store, layout, kind, &nodes[nodeI], childI, childId);
+        // The child may have been replaced or swapped without it's own layout changing.
+        nodes[nodeI].hasMeshDirtyChild = true;
 
-        maxWidth = MathInt32Max(maxWidth, localX);
-        localX = startX;
-        localY += maxHeight;
+        return;
     }
 
-    block->width = maxWidth;
-    block->height = localY;
-}
+    if (nodes[nodeI * 2].hasDirtyChild)
+    {
+        BlockUpdateLayoutNode(store, layout, kind, range, nodes, nodeI * 2);
+    }
 
-static Color BlockGetDepthColor(int32_t depth, Theme *theme)
-{
-    if (depth % 2 == 0)
+    if (nodes[nodeI * 2 + 1].hasDirtyChild)
     {
-        return theme->evenColor;
+        BlockUpdateLayoutNode(store, layout, kind, range, nodes, nodeI * 2 + 1);
     }
 
-    return theme->oddColor;
+    BlockCombineLayoutNodes(nodes, nodeI);
 }
 
-static int32_t BlockFindFirstVisibleChildI(Block *block, int32_t childrenCount, Camera *camera, int32_t y)
+static void BlockRebuildLayoutNodes(
+    BlockStore *store, BlockLayout *layout, const BlockKind *kind, BlockChildRange range, BlockLayoutNode *nodes)
 {
-    int32_t minI = 0;
-    int32_t maxI = childrenCount - 1;
-
-    if (maxI < 1)
+    for (int32_t i = 0; i < range.capacity; i++)
     {
-        return 0;
-    }
+        BlockLayoutNode *leaf = &nodes[range.capacity + i];
 
-    while (minI != maxI)
-    {
-        int32_t i = (minI + maxI) / 2;
-        Block *child = BlockGetChild(block, i);
-
-        if (y + child->y + child->height < camera->y)
-        {
-            minI += 1;
-        }
-        else
+        if (i >= range.count)
         {
-            maxI = i;
+            *leaf = (BlockLayoutNode){0};
+            continue;
         }
+
+        BlockId childId = store->childIds.data[range.start + i];
+
+        BlockUpdateLayoutById(store, childId);
+        BlockUpdateLayoutLeaf(store, layout, kind, leaf, i, childId);
     }
 
-    return minI;
+    for (int32_t nodeI = range.capacity - 1; nodeI > 0; nodeI--)
+    {
+        BlockCombineLayoutNodes(nodes, nodeI);
+    }
 }
 
-void BlockDraw(
-    Block *block, Block *cursorBlock, int32_t depth, Camera *camera, Font *font, Theme *theme, int32_t x, int32_t y)
+static void BlockUpdateLayoutById(BlockStore *store, BlockId id)
 {
-    x += block->x;
-    y += block->y;
+    BlockLayout *layout = &store->layouts.data[id];
 
-    if (block->kindId == BlockKindIdPin)
-    {
-        ColorSet(theme->pinColor);
-    }
-    else
+    if (!layout->needsUpdate)
     {
-        ColorSet(BlockGetDepthColor(depth, theme));
+        return;
     }
 
-    DrawRect(
-        (float)x - BlockPaddingX, (float)y - BlockPaddingY, (float)block->width, (float)block->height, camera->zoom);
+    BlockKindId kindId = store->kindIds.data[id];
+    const BlockKind *kind = &BlockKinds[kindId];
 
-    ColorSet(theme->textColor);
+    int32_t textWidth, textHeight;
+    BlockGetTextSizeById(store, id, &textWidth, &textHeight);
 
-    int32_t textY = y - FontAscent;
-    int32_t childrenCount = BlockGetChildrenCount(block);
-    bool hasChildren = childrenCount > 0;
+    BlockChildRange range = store->childRanges.data[id];
+    int32_t startX = BlockGetChildrenStartX(kindId, textWidth);
 
-    if (!hasChildren)
+    if (range.count == 0)
     {
-        textY -= BlockPaddingY;
+        layout->width = kind->isVertical ? 0 : startX;
+        layout->height = textHeight;
+        layout->needsUpdate = false;
+        layout->needsRebuild = false;
+        layout->needsMeshUpdate = true;
+
+        return;
     }
 
-    const BlockKind *kind = &BlockKinds[block->kindId];
-    char *text = BlockGetText(block);
+    BlockLayoutNode *nodes = BlockStoreGetLayoutNodes(store, id);
 
-    // TODO: Also do this is the text is infix, but
-    // the node has < 2 children. eg. so that -/+
-    // can be used as unary operators too.
-    // Allows writing -x, +x instead of 0-x, 0+x.
-    if (!kind->isTextInfix)
+    if (layout->needsRebuild)
     {
-        FontDraw(text, x * camera->zoom, textY * camera->zoom, font);
+        BlockRebuildLayoutNodes(store, layout, kind, range, nodes);
     }
-
-    if (!hasChildren)
+    else if (nodes[1].hasDirtyChild)
     {
-        return;
+        BlockUpdateLayoutNode(store, layout, kind, range, nodes, 1);
     }
 
-    int32_t firstVisibleI = BlockFindFirstVisibleChildI(block, childrenCount, camera, y);
+    BlockLayoutNode *root = &nodes[1];
 
-    for (int32_t i = firstVisibleI; i < childrenCount; i++)
+    if (kind->isVertical)
     {
-        Block *child = BlockGetChild(block, i);
+        layout->width = startX + root->crossExtent + BlockPaddingX;
+        layout->height = BlockPaddingY + root->mainExtent;
+    }
+    else
+    {
+        int32_t infixWidth = kind->isTextInfix ? kind->textWidth + BlockPaddingX : 0;
 
-        if (y + child->y > camera->y + camera->height / camera->zoom)
-        {
-            break;
-        }
+        // The infix text is only placed between children, not after the last one.
+        layout->width = startX + root->mainExtent - infixWidth;
+        layout->height = BlockPaddingY + root->crossExtent + BlockPaddingY;
+    }
 
-        BlockDraw(child, cursorBlock, depth + 1, camera, font, theme, x, y);
+    layout->needsUpdate = false;
+    layout->needsRebuild = false;
+    layout->needsMeshUpdate = true;
+}
 
-        if (i < childrenCount - 1 && kind->isTextInfix)
-        {
-            FontDraw(text, (x + child->x + child->width) * camera->zoom,
-                (textY + (child->height - kind->textHeight) / 2) * camera->zoom, font);
-        }
-    }
+void BlockUpdateTree(Block *block)
+{
+    TracerBegin("BlockUpdateTree");
+    BlockUpdateLayoutById(&block->arena->store, block->id);
+    TracerEnd("BlockUpdateTree");
 }
\ No newline at end of file
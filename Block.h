@@ -1,10 +1,13 @@
 #pragma once
 
+#include "BlockArena.h"
 #include "Font.h"
 #include "Theme.h"
 #include "List.h"
 #include "Camera.h"
 #include "Saver.h"
+#include "StringTable.h"
+#include "RectBatch.h"
 
 #include <inttypes.h>
 #include <stdbool.h>
@@ -88,6 +91,7 @@ typedef struct BlockKind
 {
     char *searchText;
     char *text;
+    int32_t textLength;
     int32_t textWidth;
     int32_t textHeight;
     bool isVertical;
@@ -104,37 +108,13 @@ BlockKind BlockKinds[BlockKindIdCount];
 
 typedef struct Block Block;
 
-typedef Block *BlockPointer;
-ListDefine(BlockPointer);
-
-typedef struct BlockParentData
-{
-    List_BlockPointer children;
-} BlockParentData;
-
-typedef struct BlockIdentifierData
-{
-    char *text;
-    int32_t textWidth;
-    int32_t textHeight;
-} BlockIdentifierData;
-
-// A block can either be a parent or an identifier.
-typedef union BlockData
-{
-    BlockParentData parent;
-    BlockIdentifierData identifier;
-} BlockData;
-
+// Layout and children are kept in the arena's block store, indexed by the block's id.
 typedef struct Block
 {
-    BlockData data;
+    InternedString *identifier;
     Block *parent;
-
-    int32_t x;
-    int32_t y;
-    int32_t width;
-    int32_t height;
+    BlockArena *arena;
+    BlockId id;
 
     int32_t childI;
     BlockKindId kindId;
@@ -150,15 +130,17 @@ void BlockKindsInit(void);
 void BlockKindsDeinit(void);
 void BlockKindsUpdateTextSize(Font *font);
 
-Block *BlockNew(BlockKindId kindId, Block *parent, int32_t childI);
-Block *BlockNewIdentifier(char *text, int32_t textLength, Font *font, Block *parent, int32_t childI);
-Block *BlockCopy(Block *other, Block *parent, int32_t childI);
+Block *BlockNew(BlockArena *arena, BlockKindId kindId, Block *parent, int32_t childI);
+Block *BlockNewIdentifier(BlockArena *arena, char *text, int32_t textLength, Block *parent, int32_t childI);
+Block *BlockCopy(BlockArena *arena, Block *other, Block *parent, int32_t childI);
 void BlockDelete(Block *block);
 void BlockMarkNeedsUpdate(Block *block);
 bool BlockContainsNonPin(Block *block);
 int32_t BlockGetChildrenCount(Block *block);
-char *BlockGetText(Block *block);
+char *BlockGetText(Block *block, int32_t *textLength);
 void BlockGetTextSize(Block *block, int32_t *width, int32_t *height);
+void BlockGetSize(Block *block, int32_t *width, int32_t *height);
+int32_t BlockGetChildrenStartX(BlockKindId kindId, int32_t textWidth);
 DefaultChildKind *BlockGetDefaultChildKind(Block *block, int32_t childI);
 Block *BlockGetChild(Block *block, int32_t childI);
 void BlockGetGlobalPosition(Block *block, int32_t *x, int32_t *y);
@@ -169,5 +151,7 @@ void BlockInsertChild(Block *block, Block *child, int32_t childI);
 BlockDeleteResult BlockDeleteChild(Block *block, int32_t childI, bool doDelete);
 void BlockSwapChildren(Block *block, int32_t firstChildI, int32_t secondChildI);
 uint64_t BlockCountAll(Block *block);
-void BlockUpdateTree(Block *block, int32_t x, int32_t y);
-void BlockDraw(Block *block, Block *cursorBlock, int32_t depth, Camera *camera, Font *font, Theme *theme, int32_t x, int32_t y);
\ No newline at end of file
+void BlockUpdateTree(Block *block);
+void BlockUpdateMesh(Block *block, RectBatch *batch, Theme *theme);
+void BlockDraw(Block *block, Block *cursorBlock, int32_t depth, Camera *camera, Font *font, Theme *theme,
+    int32_t x, int32_t y);
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "BlockArena.h"
+#include "Block.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+static const size_t PoolChunkSize = 64 * 1024;
+
+typedef struct PoolChunk
+{
+    PoolChunk *next;
+    // Marks where the items start, keeping them aligned.
+    double alignment;
+} PoolChunk;
+
+static Pool PoolNew(size_t itemSize)
+{
+    assert(itemSize >= sizeof(void *));
+
+    return (Pool){
+        .itemSize = itemSize,
+    };
+}
+
+static void PoolDelete(Pool *pool)
+{
+    PoolChunk *chunk = pool->chunks;
+
+    while (chunk)
+    {
+        PoolChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    *pool = PoolNew(pool->itemSize);
+}
+
+static bool PoolHasFreeItem(Pool *pool)
+{
+    return pool->freeItems || (size_t)(pool->chunkEnd - pool->nextItem) >= pool->itemSize;
+}
+
+static void *PoolAllocate(Pool *pool)
+{
+    if (pool->freeItems)
+    {
+        void *item = pool->freeItems;
+        pool->freeItems = *(void **)item;
+
+        return item;
+    }
+
+    if (!PoolHasFreeItem(pool))
+    {
+        size_t itemCount = (PoolChunkSize - offsetof(PoolChunk, alignment)) / pool->itemSize;
+
+        if (itemCount < 1)
+        {
+            itemCount = 1;
+        }
+
+        PoolChunk *chunk = malloc(offsetof(PoolChunk, alignment) + itemCount * pool->itemSize);
+        assert(chunk);
+
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+
+        pool->nextItem = (uint8_t *)&chunk->alignment;
+        pool->chunkEnd = pool->nextItem + itemCount * pool->itemSize;
+    }
+
+    void *item = pool->nextItem;
+    pool->nextItem += pool->itemSize;
+
+    return item;
+}
+
+static void PoolFree(Pool *pool, void *item)
+{
+    *(void **)item = pool->freeItems;
+    pool->freeItems = item;
+}
+
+BlockArena BlockArenaNew(void)
+{
+    BlockArena arena = (BlockArena){
+        .blockPool = PoolNew(sizeof(Block)),
+        .store = BlockStoreNew(),
+    };
+
+    return arena;
+}
+
+void BlockArenaDelete(BlockArena *arena)
+{
+    PoolDelete(&arena->blockPool);
+    arena->deletedBlocks = NULL;
+
+    BlockStoreDelete(&arena->store);
+}
+
+// Takes apart the most recently deleted block, it's children are queued to be reclaimed later.
+// Identifier text is interned, so it's never freed here.
+static bool BlockArenaReclaimBlock(BlockArena *arena)
+{
+    Block *block = arena->deletedBlocks;
+
+    if (!block)
+    {
+        return false;
+    }
+
+    arena->deletedBlocks = block->parent;
+
+    int32_t childrenCount = BlockStoreGetChildrenCount(&arena->store, block->id);
+
+    for (int32_t i = 0; i < childrenCount; i++)
+    {
+        BlockId childId = BlockStoreGetChild(&arena->store, block->id, i);
+        BlockArenaFreeBlock(arena, arena->store.blocks.data[childId]);
+    }
+
+    BlockStoreRemove(&arena->store, block->id);
+    PoolFree(&arena->blockPool, block);
+
+    return true;
+}
+
+// Takes apart every deleted block now, instead of as their memory is needed.
+void BlockArenaReclaimDeletedBlocks(BlockArena *arena)
+{
+    while (BlockArenaReclaimBlock(arena))
+    {
+    }
+}
+
+Block *BlockArenaAllocateBlock(BlockArena *arena)
+{
+    if (!arena->blockPool.freeItems)
+    {
+        BlockArenaReclaimBlock(arena);
+    }
+
+    return PoolAllocate(&arena->blockPool);
+}
+
+void BlockArenaFreeBlock(BlockArena *arena, Block *block)
+{
+    // The block is dead, so it's parent pointer can be reused to link it into the deleted list.
+    block->parent = arena->deletedBlocks;
+    arena->deletedBlocks = block;
+}
\ No newline at end of file
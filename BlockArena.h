@@ -0,0 +1,38 @@
+#pragma once
+
+#include "BlockStore.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct PoolChunk PoolChunk;
+
+// Hands out fixed size items from large chunks, freed items are reused before new chunks are allocated.
+typedef struct Pool
+{
+    PoolChunk *chunks;
+    void *freeItems;
+    uint8_t *nextItem;
+    uint8_t *chunkEnd;
+    size_t itemSize;
+} Pool;
+
+// Owns all of a document's blocks, along with the store holding their layout and children.
+// Deleting the arena frees everything at once, without walking the tree.
+typedef struct BlockArena
+{
+    Pool blockPool;
+
+    // Deleted subtrees are kept here and only taken apart when their memory is needed again,
+    // so that deleting a block is O(1) no matter how big it's subtree is.
+    Block *deletedBlocks;
+
+    BlockStore store;
+} BlockArena;
+
+BlockArena BlockArenaNew(void);
+void BlockArenaDelete(BlockArena *arena);
+void BlockArenaReclaimDeletedBlocks(BlockArena *arena);
+Block *BlockArenaAllocateBlock(BlockArena *arena);
+void BlockArenaFreeBlock(BlockArena *arena, Block *block);
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include "Block.h"
+#include "Math.h"
+#include "Profiler.h"
+#include "RectBatch.h"
+#include "Shapes.h"
+#include "Tracer.h"
+
+#include <math.h>
+
+static Color BlockGetDepthColor(int32_t depth, Theme *theme)
+{
+    if (depth % 2 == 0)
+    {
+        return theme->evenColor;
+    }
+
+    return theme->oddColor;
+}
+
+// State shared by every level of a draw, the view is the area visible to the camera in world space.
+typedef struct BlockDrawContext
+{
+    BlockStore *store;
+    Camera *camera;
+    Font *font;
+    Theme *theme;
+
+    int32_t viewLeft;
+    int32_t viewTop;
+    int32_t viewRight;
+    int32_t viewBottom;
+
+    // Used as a stack, each level of the tree pushes it's visible children and pops them once they're drawn.
+    List_BlockChildOffset *visibleChildren;
+} BlockDrawContext;
+
+// Finds the children that intersect the view, using the block's layout tree along it's main axis,
+// and the maximum cross extent of each subtree to skip children that are too short or narrow to reach the view.
+static void BlockFindVisibleChildren(
+    BlockDrawContext *context, BlockId id, const BlockKind *kind, int32_t childrenX, int32_t childrenY)
+{
+    BlockExtentQuery query;
+
+    if (kind->isVertical)
+    {
+        if (childrenX - BlockPaddingX >= context->viewRight)
+        {
+            return;
+        }
+
+        query = (BlockExtentQuery){
+            .mainMin = context->viewTop - (childrenY - BlockPaddingY),
+            .mainMax = context->viewBottom - (childrenY - BlockPaddingY),
+            .crossMin = context->viewLeft - (childrenX - BlockPaddingX),
+        };
+    }
+    else
+    {
+        if (childrenY - BlockPaddingY >= context->viewBottom)
+        {
+            return;
+        }
+
+        query = (BlockExtentQuery){
+            .mainMin = context->viewLeft - (childrenX - BlockPaddingX),
+            .mainMax = context->viewRight - (childrenX - BlockPaddingX),
+            .crossMin = context->viewTop - (childrenY - BlockPaddingY),
+        };
+    }
+
+    BlockStoreFindChildrenInRange(context->store, id, &query, context->visibleChildren);
+}
+
+// When zoomed out far enough that text can't be read, a bar is drawn in it's place instead.
+static void BlockDrawText(BlockDrawContext *context, char *text, int32_t textLength, int32_t textWidth,
+    int32_t textHeight, int32_t x, int32_t y)
+{
+    Camera *camera = context->camera;
+
+    if (textHeight * camera->zoom >= TextLodMinPixelHeight)
+    {
+        FontDrawSpan(text, textLength, x * camera->zoom, y * camera->zoom, context->font);
+        return;
+    }
+
+    if (textWidth > 0)
+    {
+        DrawRect((float)x, (float)(y + FontAscent) + textHeight / 4.0f, (float)textWidth, textHeight / 2.0f,
+            camera->zoom);
+    }
+}
+
+static void BlockDrawById(BlockDrawContext *context, BlockId id, int32_t depth, int32_t x, int32_t y)
+{
+    BlockStore *store = context->store;
+    Camera *camera = context->camera;
+
+    BlockLayout *layout = &store->layouts.data[id];
+    BlockKindId kindId = store->kindIds.data[id];
+
+    ProfilerCount(ProfilerCounterBlocksVisited, 1);
+
+    BlockChildRange range = store->childRanges.data[id];
+    int32_t childrenCount = range.count;
+    bool hasChildren = childrenCount > 0;
+
+    // Anything inside of a block this small wouldn't be visible, so only the block's background is left.
+    // Blocks without children only contain their text, which can be wider than the block when it's vertical.
+    float lodSize = hasChildren ? MathFloatMin((float)layout->width, (float)layout->height) : (float)layout->height;
+
+    if (lodSize * camera->zoom < BlockLodMinPixelSize)
+    {
+        ProfilerCount(ProfilerCounterBlocksCollapsed, 1);
+        return;
+    }
+
+    int32_t textY = y - FontAscent;
+
+    if (!hasChildren)
+    {
+        textY -= BlockPaddingY;
+    }
+
+    const BlockKind *kind = &BlockKinds[kindId];
+    char *text = kind->text;
+    int32_t textLength = kind->textLength;
+    int32_t textWidth = kind->textWidth;
+    int32_t textHeight = kind->textHeight;
+
+    if (kindId == BlockKindIdIdentifier)
+    {
+        Block *block = store->blocks.data[id];
+
+        text = block->identifier->text;
+        textLength = block->identifier->textLength;
+        BlockGetTextSize(block, &textWidth, &textHeight);
+    }
+
+    // TODO: Also do this is the text is infix, but
+    // the node has < 2 children. eg. so that -/+
+    // can be used as unary operators too.
+    // Allows writing -x, +x instead of 0-x, 0+x.
+    if (!kind->isTextInfix)
+    {
+        BlockDrawText(context, text, textLength, textWidth, textHeight, x, textY);
+    }
+
+    if (!hasChildren)
+    {
+        return;
+    }
+
+    int32_t childrenX = x + BlockGetChildrenStartX(kindId, kind->textWidth);
+    int32_t childrenY = y + BlockPaddingY;
+
+    int32_t visibleStart = context->visibleChildren->count;
+    BlockFindVisibleChildren(context, id, kind, childrenX, childrenY);
+    int32_t visibleEnd = context->visibleChildren->count;
+
+    ProfilerCount(ProfilerCounterBlocksCulled, childrenCount - (visibleEnd - visibleStart));
+
+    for (int32_t i = visibleStart; i < visibleEnd; i++)
+    {
+        // Drawing children pushes to the stack, so the visible child is copied rather than pointed to.
+        BlockChildOffset visibleChild = context->visibleChildren->data[i];
+        BlockId childId = store->childIds.data[range.start + visibleChild.childI];
+
+        int32_t childX = kind->isVertical ? childrenX : childrenX + visibleChild.offset;
+        int32_t childY = kind->isVertical ? childrenY + visibleChild.offset : childrenY;
+
+        BlockDrawById(context, childId, depth + 1, childX, childY);
+
+        if (visibleChild.childI < childrenCount - 1 && kind->isTextInfix)
+        {
+            BlockLayout *childLayout = &store->layouts.data[childId];
+
+            BlockDrawText(context, text, textLength, textWidth, textHeight, childX + childLayout->width,
+                textY + (childLayout->height - kind->textHeight) / 2);
+        }
+    }
+
+    context->visibleChildren->count = visibleStart;
+}
+
+// Clears the geometry of a block that has left the tree, along with everything below it.
+static void BlockClearMeshById(BlockStore *store, RectBatch *batch, BlockId id)
+{
+    RectBatchSet(batch, (int32_t)id, 0, 0, 0, 0, (Color){0});
+    store->layouts.data[id].needsMeshUpdate = true;
+    store->layouts.data[id].firstMovedChildI = 0;
+
+    BlockChildRange range = store->childRanges.data[id];
+
+    for (int32_t i = 0; i < range.count; i++)
+    {
+        BlockClearMeshById(store, batch, store->childIds.data[range.start + i]);
+    }
+}
+
+// The children of a block whose geometry is being rewritten, and where they're placed.
+typedef struct BlockMeshChildren
+{
+    const BlockKind *kind;
+    BlockChildRange range;
+    BlockLayoutNode *nodes;
+    int32_t x;
+    int32_t y;
+    int32_t depth;
+    int32_t firstMovedChildI;
+} BlockMeshChildren;
+
+static void BlockUpdateMeshById(BlockStore *store, RectBatch *batch, Theme *theme, BlockId id, int32_t depth,
+    int32_t x, int32_t y);
+
+// Only descends into nodes with a changed child, or that contain children which moved,
+// so a change costs O(log n) in it's parent's tree, along with rewriting whatever it moved.
+static void BlockUpdateMeshNode(BlockStore *store, RectBatch *batch, Theme *theme, BlockMeshChildren *children,
+    int32_t nodeI, int32_t firstChildI, int32_t childCount, int32_t offset)
+{
+    BlockLayoutNode *node = &children->nodes[nodeI];
+
+    if (firstChildI >= children->range.count ||
+        (!node->hasMeshDirtyChild && firstChildI + childCount <= children->firstMovedChildI))
+    {
+        return;
+    }
+
+    node->hasMeshDirtyChild = false;
+
+    if (nodeI >= children->range.capacity)
+    {
+        BlockId childId = store->childIds.data[children->range.start + firstChildI];
+        int32_t childX = children->kind->isVertical ? children->x : children->x + offset;
+        int32_t childY = children->kind->isVertical ? children->y + offset : children->y;
+
+        BlockUpdateMeshById(store, batch, theme, childId, children->depth + 1, childX, childY);
+
+        return;
+    }
+
+    int32_t halfChildCount = childCount / 2;
+
+    BlockUpdateMeshNode(store, batch, theme, children, nodeI * 2, firstChildI, halfChildCount, offset);
+    BlockUpdateMeshNode(store, batch, theme, children, nodeI * 2 + 1, firstChildI + halfChildCount, halfChildCount,
+        offset + children->nodes[nodeI * 2].mainExtent);
+}
+
+static void BlockUpdateMeshById(BlockStore *store, RectBatch *batch, Theme *theme, BlockId id, int32_t depth,
+    int32_t x, int32_t y)
+{
+    BlockLayout *layout = &store->layouts.data[id];
+    float rectX = (float)(x - BlockPaddingX);
+    float rectY = (float)(y - BlockPaddingY);
+
+    float oldX, oldY;
+    RectBatchGetPosition(batch, (int32_t)id, &oldX, &oldY);
+
+    bool hasMoved = oldX != rectX || oldY != rectY;
+
+    // Subtrees that haven't changed or moved are already correct, they're skipped without visiting their children.
+    if (!layout->needsMeshUpdate && !hasMoved)
+    {
+        return;
+    }
+
+    BlockKindId kindId = store->kindIds.data[id];
+    Color color = kindId == BlockKindIdPin ? theme->pinColor : BlockGetDepthColor(depth, theme);
+
+    RectBatchSet(batch, (int32_t)id, rectX, rectY, (float)layout->width, (float)layout->height, color);
+    layout->needsMeshUpdate = false;
+
+    ProfilerCount(ProfilerCounterRectsRewritten, 1);
+
+    BlockChildRange range = store->childRanges.data[id];
+    // When the block itself moved, so did all of it's children.
+    int32_t firstMovedChildI = hasMoved ? 0 : layout->firstMovedChildI;
+    layout->firstMovedChildI = INT32_MAX;
+
+    if (range.count == 0)
+    {
+        return;
+    }
+
+    const BlockKind *kind = &BlockKinds[kindId];
+    BlockMeshChildren children = {
+        .kind = kind,
+        .range = range,
+        .nodes = BlockStoreGetLayoutNodes(store, id),
+        .x = x + BlockGetChildrenStartX(kindId, kind->textWidth),
+        .y = y + BlockPaddingY,
+        .depth = depth,
+        .firstMovedChildI = firstMovedChildI,
+    };
+
+    BlockUpdateMeshNode(store, batch, theme, &children, 1, 0, range.capacity, 0);
+}
+
+// Block backgrounds are kept in a retained rect batch, indexed by block id. Only blocks whose layout changed,
+// that moved, or that left the tree since the last update are rewritten, so frames that only move the camera
+// don't touch the batch at all. Unchanged children of a changed block are skipped without being visited,
+// but moving a block still means rewriting everything inside of it, since rects are stored in world space.
+void BlockUpdateMesh(Block *block, RectBatch *batch, Theme *theme)
+{
+    TracerBegin("BlockUpdateMesh");
+
+    BlockStore *store = &block->arena->store;
+
+    // Blocks that left the tree before the first update were never part of the mesh.
+    store->tracksDetachedIds = true;
+
+    for (int32_t i = 0; i < store->detachedIds.count; i++)
+    {
+        BlockClearMeshById(store, batch, store->detachedIds.data[i]);
+    }
+
+    for (int32_t i = 0; i < store->removedIds.count; i++)
+    {
+        RectBatchSet(batch, (int32_t)store->removedIds.data[i], 0, 0, 0, 0, (Color){0});
+    }
+
+    BlockStoreFlushDetachedIds(store);
+
+    BlockUpdateMeshById(store, batch, theme, block->id, 0, 0, 0);
+
+    TracerEnd("BlockUpdateMesh");
+}
+
+// Block backgrounds are drawn from the mesh, so only text is drawn here. All of it is submitted at once at the end.
+void BlockDraw(Block *block, Block *cursorBlock, int32_t depth, Camera *camera, Font *font, Theme *theme,
+    int32_t x, int32_t y)
+{
+    (void)cursorBlock;
+
+    TracerBegin("BlockDraw");
+
+    ColorSet(theme->textColor);
+
+    BlockStore *store = &block->arena->store;
+    ListReset_BlockChildOffset(&store->visibleChildren);
+
+    BlockDrawContext context = {
+        .store = store,
+        .camera = camera,
+        .font = font,
+        .theme = theme,
+        .viewLeft = (int32_t)floorf(camera->x),
+        .viewTop = (int32_t)floorf(camera->y),
+        .viewRight = (int32_t)ceilf(camera->x + camera->width / camera->zoom),
+        .viewBottom = (int32_t)ceilf(camera->y + camera->height / camera->zoom),
+        .visibleChildren = &store->visibleChildren,
+    };
+
+    BlockDrawById(&context, block->id, depth, x, y);
+
+    FontFlush(font);
+
+    TracerEnd("BlockDraw");
+}
\ No newline at end of file
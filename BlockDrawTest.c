@@ -0,0 +1,145 @@
+#include "Block.h"
+#include "Profiler.h"
+#include "RectBatch.h"
+#include "Shapes.h"
+#include "StringTable.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Headless tests for drawing blocks at different levels of detail, run by ctest.
+ * Text is drawn with the benchmark's stand in font, which only counts the glyphs that would have been drawn.
+ */
+
+static const float TestFontSize = 16;
+static const float TestViewSize = 4096;
+// Small enough that every block with children is collapsed.
+static const float TestFarZoom = 0.01f;
+
+// Backgrounds aren't checked here, so they aren't drawn.
+void DrawRect(float x, float y, float width, float height, float scale)
+{
+    (void)x, (void)y, (void)width, (void)height, (void)scale;
+}
+
+void ColorSet(Color color)
+{
+    (void)color;
+}
+
+void RectBatchSet(RectBatch *batch, int32_t i, float x, float y, float width, float height, Color color)
+{
+    (void)batch, (void)i, (void)x, (void)y, (void)width, (void)height, (void)color;
+}
+
+void RectBatchGetPosition(RectBatch *batch, int32_t i, float *x, float *y)
+{
+    (void)batch, (void)i;
+
+    *x = 0;
+    *y = 0;
+}
+
+static void TestDraw(Block *block, Font *font, float zoom, int64_t *glyphsDrawn, int64_t *blocksCollapsed)
+{
+    Theme theme = {0};
+    Camera camera = {
+        .x = -TestViewSize / 2,
+        .y = -TestViewSize / 2,
+        .width = TestViewSize * zoom,
+        .height = TestViewSize * zoom,
+        .zoom = zoom,
+    };
+
+    BlockDraw(block, NULL, 0, &camera, font, &theme, 0, 0);
+    ProfilerEndFrame();
+
+    *glyphsDrawn = ProfilerGetCounter(ProfilerCounterGlyphsDrawn);
+    *blocksCollapsed = ProfilerGetCounter(ProfilerCounterBlocksCollapsed);
+}
+
+// Vertical blocks without children have no width, but their text still needs to be drawn.
+static bool TestChildlessVerticalBlocks(Font *font)
+{
+    bool passed = true;
+
+    for (int32_t kindId = 0; kindId < BlockKindIdCount; kindId++)
+    {
+        const BlockKind *kind = &BlockKinds[kindId];
+
+        if (!kind->isVertical || !kind->text)
+        {
+            continue;
+        }
+
+        BlockArena arena = BlockArenaNew();
+        BlockStore *store = &arena.store;
+        Block *block = BlockNew(&arena, kindId, NULL, 0);
+
+        while (BlockStoreGetChildrenCount(store, block->id) > 0)
+        {
+            BlockStoreRemoveChild(store, block->id, 0);
+        }
+
+        BlockMarkNeedsUpdate(block);
+        BlockUpdateTree(block);
+
+        int64_t glyphsDrawn, blocksCollapsed;
+        TestDraw(block, font, 1.0f, &glyphsDrawn, &blocksCollapsed);
+
+        if (glyphsDrawn != kind->textLength || blocksCollapsed != 0)
+        {
+            printf("Childless vertical block \"%s\" drew %" PRId64 " of %d glyphs, with %" PRId64
+                   " blocks collapsed.\n",
+                kind->text, glyphsDrawn, kind->textLength, blocksCollapsed);
+            passed = false;
+        }
+
+        BlockArenaDelete(&arena);
+    }
+
+    return passed;
+}
+
+// Zoomed out far enough, blocks with children are drawn without any of their contents.
+static bool TestZoomedOutBlocksCollapse(Font *font)
+{
+    BlockArena arena = BlockArenaNew();
+    Block *block = BlockNew(&arena, BlockKindIdFunction, NULL, 0);
+    BlockUpdateTree(block);
+
+    int64_t glyphsDrawn, blocksCollapsed;
+    TestDraw(block, font, TestFarZoom, &glyphsDrawn, &blocksCollapsed);
+
+    BlockArenaDelete(&arena);
+
+    if (glyphsDrawn != 0 || blocksCollapsed != 1)
+    {
+        printf("Zoomed out function drew %" PRId64 " glyphs, with %" PRId64 " blocks collapsed.\n", glyphsDrawn,
+            blocksCollapsed);
+        return false;
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    Font *font = FontNew("Test", NULL, 0, TestFontSize);
+
+    BlockKindsInit();
+    BlockKindsUpdateTextSize(font);
+    StringTableInit();
+
+    bool passed = true;
+    passed = TestChildlessVerticalBlocks(font) && passed;
+    passed = TestZoomedOutBlocksCollapse(font) && passed;
+
+    StringTableDeinit();
+    BlockKindsDeinit();
+    FontDelete(font);
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
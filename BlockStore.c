@@ -0,0 +1,396 @@
+#include "BlockStore.h"
+#include "Math.h"
+
+#include <assert.h>
+
+static const int32_t BlockStoreInitialCapacity = 1024;
+static const int32_t MinChildCapacity = 2;
+
+BlockStore BlockStoreNew(void)
+{
+    return (BlockStore){
+        .blocks = ListNew_BlockPointer(BlockStoreInitialCapacity),
+        .kindIds = ListNew_BlockKindIdByte(BlockStoreInitialCapacity),
+        .layouts = ListNew_BlockLayout(BlockStoreInitialCapacity),
+        .childRanges = ListNew_BlockChildRange(BlockStoreInitialCapacity),
+        .childIds = ListNew_BlockId(BlockStoreInitialCapacity),
+        .layoutNodes = ListNew_BlockLayoutNode(BlockStoreInitialCapacity * 2),
+        .freeIds = ListNew_BlockId(BlockStoreInitialCapacity),
+        .detachedIds = ListNew_BlockId(BlockStoreInitialCapacity),
+        .removedIds = ListNew_BlockId(BlockStoreInitialCapacity),
+        .visibleChildren = ListNew_BlockChildOffset(BlockStoreInitialCapacity),
+    };
+}
+
+void BlockStoreDelete(BlockStore *store)
+{
+    ListDelete_BlockPointer(&store->blocks);
+    ListDelete_BlockKindIdByte(&store->kindIds);
+    ListDelete_BlockLayout(&store->layouts);
+    ListDelete_BlockChildRange(&store->childRanges);
+    ListDelete_BlockId(&store->childIds);
+    ListDelete_BlockLayoutNode(&store->layoutNodes);
+    ListDelete_BlockId(&store->freeIds);
+    ListDelete_BlockId(&store->detachedIds);
+    ListDelete_BlockId(&store->removedIds);
+    ListDelete_BlockChildOffset(&store->visibleChildren);
+}
+
+BlockId BlockStoreAdd(BlockStore *store, Block *block, uint8_t kindId)
+{
+    BlockId id;
+
+    if (store->freeIds.count > 0)
+    {
+        id = ListPop_BlockId(&store->freeIds);
+    }
+    else
+    {
+        id = (BlockId)store->blocks.count;
+
+        ListPush_BlockPointer(&store->blocks, NULL);
+        ListPush_BlockKindIdByte(&store->kindIds, 0);
+        ListPush_BlockLayout(&store->layouts, (BlockLayout){0});
+        ListPush_BlockChildRange(&store->childRanges, (BlockChildRange){0});
+    }
+
+    store->blocks.data[id] = block;
+    store->kindIds.data[id] = kindId;
+    store->layouts.data[id] = (BlockLayout){
+        .needsUpdate = true,
+        .needsRebuild = true,
+        .needsMeshUpdate = true,
+    };
+    store->childRanges.data[id] = (BlockChildRange){0};
+
+    return id;
+}
+
+void BlockStoreRemove(BlockStore *store, BlockId id)
+{
+    BlockChildRange *range = &store->childRanges.data[id];
+
+    if (store->tracksDetachedIds)
+    {
+        // The children can't be found from this block once it's gone, so they're recorded separately.
+        for (int32_t i = 0; i < range->count; i++)
+        {
+            ListPush_BlockId(&store->detachedIds, store->childIds.data[range->start + i]);
+        }
+
+        ListPush_BlockId(&store->removedIds, id);
+    }
+    else
+    {
+        ListPush_BlockId(&store->freeIds, id);
+    }
+
+    store->unusedChildIdCount += range->capacity;
+    *range = (BlockChildRange){0};
+    store->blocks.data[id] = NULL;
+}
+
+// Forgets the recorded detached ids, allowing removed ids to be reused.
+void BlockStoreFlushDetachedIds(BlockStore *store)
+{
+    for (int32_t i = 0; i < store->removedIds.count; i++)
+    {
+        ListPush_BlockId(&store->freeIds, store->removedIds.data[i]);
+    }
+
+    ListReset_BlockId(&store->removedIds);
+    ListReset_BlockId(&store->detachedIds);
+}
+
+// Moves every range to the start of the child id list, dropping the space left behind by moved or removed ranges.
+static void BlockStoreCompactChildIds(BlockStore *store)
+{
+    List_BlockId childIds = ListNew_BlockId(store->childIds.count - store->unusedChildIdCount + 1);
+    List_BlockLayoutNode layoutNodes = ListNew_BlockLayoutNode(childIds.capacity * 2);
+
+    for (int32_t i = 0; i < store->childRanges.count; i++)
+    {
+        BlockChildRange *range = &store->childRanges.data[i];
+
+        if (range->capacity == 0)
+        {
+            continue;
+        }
+
+        int32_t start = childIds.count;
+
+        for (int32_t childI = 0; childI < range->capacity; childI++)
+        {
+            ListPush_BlockId(&childIds, store->childIds.data[range->start + childI]);
+        }
+
+        for (int32_t nodeI = 0; nodeI < range->capacity * 2; nodeI++)
+        {
+            ListPush_BlockLayoutNode(&layoutNodes, store->layoutNodes.data[range->start * 2 + nodeI]);
+        }
+
+        range->start = start;
+    }
+
+    ListDelete_BlockId(&store->childIds);
+    store->childIds = childIds;
+    ListDelete_BlockLayoutNode(&store->layoutNodes);
+    store->layoutNodes = layoutNodes;
+    store->unusedChildIdCount = 0;
+}
+
+// Ranges that need to grow are moved to the end of the child id list,
+// the space they leave behind is reclaimed once enough of it builds up.
+void BlockStoreReserveChildren(BlockStore *store, BlockId id, int32_t capacity)
+{
+    BlockChildRange *range = &store->childRanges.data[id];
+
+    if (range->capacity >= capacity)
+    {
+        return;
+    }
+
+    int32_t newCapacity = range->capacity * 2;
+
+    if (newCapacity < capacity)
+    {
+        newCapacity = capacity;
+    }
+
+    if (newCapacity < MinChildCapacity)
+    {
+        newCapacity = MinChildCapacity;
+    }
+
+    // Capacities are kept as powers of two so that each range's layout tree is complete.
+    int32_t powerOfTwoCapacity = MinChildCapacity;
+
+    while (powerOfTwoCapacity < newCapacity)
+    {
+        powerOfTwoCapacity *= 2;
+    }
+
+    newCapacity = powerOfTwoCapacity;
+
+    int32_t newStart = store->childIds.count;
+    ListReserve_BlockId(&store->childIds, newStart + newCapacity);
+    ListReserve_BlockLayoutNode(&store->layoutNodes, (newStart + newCapacity) * 2);
+
+    for (int32_t i = 0; i < newCapacity; i++)
+    {
+        BlockId childId = i < range->count ? store->childIds.data[range->start + i] : BLOCK_ID_NONE;
+        ListPush_BlockId(&store->childIds, childId);
+    }
+
+    // The moved tree is filled in again during the next layout update.
+    for (int32_t i = 0; i < newCapacity * 2; i++)
+    {
+        ListPush_BlockLayoutNode(&store->layoutNodes, (BlockLayoutNode){0});
+    }
+
+    store->unusedChildIdCount += range->capacity;
+    range->start = newStart;
+    range->capacity = newCapacity;
+
+    BlockLayout *layout = &store->layouts.data[id];
+    layout->needsUpdate = true;
+    layout->needsRebuild = true;
+
+    if (store->unusedChildIdCount > store->childIds.count / 2)
+    {
+        BlockStoreCompactChildIds(store);
+    }
+}
+
+BlockId BlockStoreGetChild(BlockStore *store, BlockId id, int32_t childI)
+{
+    BlockChildRange *range = &store->childRanges.data[id];
+    assert(childI < range->count);
+
+    return store->childIds.data[range->start + childI];
+}
+
+int32_t BlockStoreGetChildrenCount(BlockStore *store, BlockId id)
+{
+    return store->childRanges.data[id].count;
+}
+
+// Replaces the child at childI, or appends it if childI is the end of the range.
+void BlockStoreSetChild(BlockStore *store, BlockId id, int32_t childI, BlockId childId)
+{
+    assert(childI <= store->childRanges.data[id].count);
+
+    BlockStoreReserveChildren(store, id, childI + 1);
+
+    BlockChildRange *range = &store->childRanges.data[id];
+
+    if (childI == range->count)
+    {
+        range->count += 1;
+    }
+    else if (store->tracksDetachedIds)
+    {
+        ListPush_BlockId(&store->detachedIds, store->childIds.data[range->start + childI]);
+    }
+
+    store->childIds.data[range->start + childI] = childId;
+    BlockStoreMarkChildNeedsUpdate(store, id, childI);
+}
+
+void BlockStoreInsertChild(BlockStore *store, BlockId id, int32_t childI, BlockId childId)
+{
+    BlockStoreReserveChildren(store, id, store->childRanges.data[id].count + 1);
+
+    BlockChildRange *range = &store->childRanges.data[id];
+    BlockId *childIds = store->childIds.data + range->start;
+
+    for (int32_t i = range->count; i > childI; i--)
+    {
+        childIds[i] = childIds[i - 1];
+    }
+
+    childIds[childI] = childId;
+    range->count += 1;
+
+    BlockLayout *layout = &store->layouts.data[id];
+    layout->needsUpdate = true;
+    layout->needsRebuild = true;
+    layout->firstMovedChildI = MathInt32Min(layout->firstMovedChildI, childI);
+}
+
+void BlockStoreRemoveChild(BlockStore *store, BlockId id, int32_t childI)
+{
+    BlockChildRange *range = &store->childRanges.data[id];
+    BlockId *childIds = store->childIds.data + range->start;
+
+    assert(childI < range->count);
+
+    if (store->tracksDetachedIds)
+    {
+        ListPush_BlockId(&store->detachedIds, childIds[childI]);
+    }
+
+    for (int32_t i = childI; i < range->count - 1; i++)
+    {
+        childIds[i] = childIds[i + 1];
+    }
+
+    range->count -= 1;
+
+    BlockLayout *layout = &store->layouts.data[id];
+    layout->needsUpdate = true;
+    layout->needsRebuild = true;
+    layout->firstMovedChildI = MathInt32Min(layout->firstMovedChildI, childI);
+}
+
+void BlockStoreSwapChildren(BlockStore *store, BlockId id, int32_t firstChildI, int32_t secondChildI)
+{
+    BlockId *childIds = store->childIds.data + store->childRanges.data[id].start;
+
+    BlockId firstChildId = childIds[firstChildI];
+    childIds[firstChildI] = childIds[secondChildI];
+    childIds[secondChildI] = firstChildId;
+
+    BlockStoreMarkChildNeedsUpdate(store, id, firstChildI);
+    BlockStoreMarkChildNeedsUpdate(store, id, secondChildI);
+}
+
+BlockLayoutNode *BlockStoreGetLayoutNodes(BlockStore *store, BlockId id)
+{
+    return store->layoutNodes.data + store->childRanges.data[id].start * 2;
+}
+
+// Flags the path from the child's leaf to the root of the tree, so the next update only revisits that path.
+void BlockStoreMarkChildNeedsUpdate(BlockStore *store, BlockId id, int32_t childI)
+{
+    BlockLayout *layout = &store->layouts.data[id];
+    BlockChildRange range = store->childRanges.data[id];
+
+    layout->needsUpdate = true;
+
+    // Blocks that have been removed can still refer to their old position, which may no longer exist.
+    if (childI >= range.count)
+    {
+        return;
+    }
+
+    // The whole tree is about to be rebuilt, which loses track of which child changed.
+    if (layout->needsRebuild)
+    {
+        layout->firstMovedChildI = MathInt32Min(layout->firstMovedChildI, childI);
+        return;
+    }
+
+    BlockLayoutNode *nodes = BlockStoreGetLayoutNodes(store, id);
+
+    for (int32_t nodeI = range.capacity + childI; nodeI > 0 && !nodes[nodeI].hasDirtyChild; nodeI /= 2)
+    {
+        nodes[nodeI].hasDirtyChild = true;
+    }
+}
+
+// Returns the sum of the main extents of the children before childI.
+int32_t BlockStoreGetChildOffset(BlockStore *store, BlockId id, int32_t childI)
+{
+    BlockChildRange range = store->childRanges.data[id];
+    BlockLayoutNode *nodes = BlockStoreGetLayoutNodes(store, id);
+    int32_t offset = 0;
+
+    for (int32_t nodeI = range.capacity + childI; nodeI > 1; nodeI /= 2)
+    {
+        if (nodeI % 2 == 1)
+        {
+            offset += nodes[nodeI - 1].mainExtent;
+        }
+    }
+
+    return offset;
+}
+
+static void BlockStoreFindChildrenInNode(BlockLayoutNode *nodes, BlockChildRange range, int32_t nodeI, int32_t offset,
+    BlockExtentQuery *query, List_BlockChildOffset *childOffsets)
+{
+    BlockLayoutNode *node = &nodes[nodeI];
+
+    if (offset >= query->mainMax || offset + node->mainExtent <= query->mainMin ||
+        node->crossExtent <= query->crossMin)
+    {
+        return;
+    }
+
+    if (nodeI >= range.capacity)
+    {
+        int32_t childI = nodeI - range.capacity;
+
+        if (childI < range.count)
+        {
+            BlockChildOffset childOffset = {
+                .childI = childI,
+                .offset = offset,
+            };
+
+            ListPush_BlockChildOffset(childOffsets, childOffset);
+        }
+
+        return;
+    }
+
+    BlockStoreFindChildrenInNode(nodes, range, nodeI * 2, offset, query, childOffsets);
+    BlockStoreFindChildrenInNode(
+        nodes, range, nodeI * 2 + 1, offset + nodes[nodeI * 2].mainExtent, query, childOffsets);
+}
+
+// Appends the children overlapping the query to childOffsets in order, along with their offsets.
+// Subtrees of the layout tree that are outside of the query are skipped, so this is O(k log n) for k results.
+void BlockStoreFindChildrenInRange(
+    BlockStore *store, BlockId id, BlockExtentQuery *query, List_BlockChildOffset *childOffsets)
+{
+    BlockChildRange range = store->childRanges.data[id];
+
+    if (range.count == 0)
+    {
+        return;
+    }
+
+    BlockStoreFindChildrenInNode(BlockStoreGetLayoutNodes(store, id), range, 1, 0, query, childOffsets);
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "List.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+typedef struct Block Block;
+
+typedef Block *BlockPointer;
+ListDefine(BlockPointer);
+
+typedef uint32_t BlockId;
+ListDefine(BlockId);
+
+typedef uint8_t BlockKindIdByte;
+ListDefine(BlockKindIdByte);
+
+#define BLOCK_ID_NONE UINT32_MAX
+
+typedef struct BlockLayout
+{
+    int32_t width;
+    int32_t height;
+    bool needsUpdate;
+    // Set when the block's children were inserted, removed or moved, so all of their extents need to be refreshed.
+    bool needsRebuild;
+    // Set whenever the layout changes, until the block's retained geometry has been rewritten.
+    bool needsMeshUpdate;
+    // Children from this one onwards may have moved since the geometry was rewritten, INT32_MAX when none have.
+    int32_t firstMovedChildI;
+} BlockLayout;
+
+ListDefine(BlockLayout);
+
+// Each block's children have a segment tree of their extents, so that the offset of any child can be found,
+// and changes to a child's size can be applied, without visiting all of it's siblings.
+// The main extent runs along the direction children are laid out in, and is summed, the cross extent is the maximum.
+typedef struct BlockLayoutNode
+{
+    int32_t mainExtent;
+    int32_t crossExtent;
+    bool hasDirtyChild;
+    // Set until the geometry of the children below this node has been rewritten.
+    bool hasMeshDirtyChild;
+} BlockLayoutNode;
+
+ListDefine(BlockLayoutNode);
+
+// A range along the main axis of a block's children, children are only included if their cross extent exceeds crossMin.
+typedef struct BlockExtentQuery
+{
+    int32_t mainMin;
+    int32_t mainMax;
+    int32_t crossMin;
+} BlockExtentQuery;
+
+typedef struct BlockChildOffset
+{
+    int32_t childI;
+    int32_t offset;
+} BlockChildOffset;
+
+ListDefine(BlockChildOffset);
+
+typedef struct BlockChildRange
+{
+    int32_t start;
+    int32_t count;
+    int32_t capacity;
+} BlockChildRange;
+
+ListDefine(BlockChildRange);
+
+// Keeps the data needed for layout and drawing in dense arrays indexed by block id,
+// so that walking the tree doesn't need to touch each block's cold data.
+typedef struct BlockStore
+{
+    List_BlockPointer blocks;
+    List_BlockKindIdByte kindIds;
+    List_BlockLayout layouts;
+    List_BlockChildRange childRanges;
+
+    // Each block's children are stored as a contiguous range of ids in this list.
+    List_BlockId childIds;
+    // Two nodes per child id, a range's tree starts at twice it's start and has it's leaves at capacity + childI.
+    List_BlockLayoutNode layoutNodes;
+    int32_t unusedChildIdCount;
+
+    List_BlockId freeIds;
+
+    // When tracking, blocks that leave the tree are recorded so that anything retained for them can be cleared.
+    // Removed ids aren't reused until they're flushed, so the recorded ids stay valid until then.
+    bool tracksDetachedIds;
+    List_BlockId detachedIds;
+    List_BlockId removedIds;
+
+    // Reused by every draw to hold the children that are visible, instead of allocating a list each frame.
+    List_BlockChildOffset visibleChildren;
+} BlockStore;
+
+BlockStore BlockStoreNew(void);
+void BlockStoreDelete(BlockStore *store);
+BlockId BlockStoreAdd(BlockStore *store, Block *block, uint8_t kindId);
+void BlockStoreRemove(BlockStore *store, BlockId id);
+void BlockStoreFlushDetachedIds(BlockStore *store);
+void BlockStoreReserveChildren(BlockStore *store, BlockId id, int32_t capacity);
+BlockId BlockStoreGetChild(BlockStore *store, BlockId id, int32_t childI);
+int32_t BlockStoreGetChildrenCount(BlockStore *store, BlockId id);
+void BlockStoreSetChild(BlockStore *store, BlockId id, int32_t childI, BlockId childId);
+void BlockStoreInsertChild(BlockStore *store, BlockId id, int32_t childI, BlockId childId);
+void BlockStoreRemoveChild(BlockStore *store, BlockId id, int32_t childI);
+void BlockStoreSwapChildren(BlockStore *store, BlockId id, int32_t firstChildI, int32_t secondChildI);
+BlockLayoutNode *BlockStoreGetLayoutNodes(BlockStore *store, BlockId id);
+void BlockStoreMarkChildNeedsUpdate(BlockStore *store, BlockId id, int32_t childI);
+int32_t BlockStoreGetChildOffset(BlockStore *store, BlockId id, int32_t childI);
+void BlockStoreFindChildrenInRange(
+    BlockStore *store, BlockId id, BlockExtentQuery *query, List_BlockChildOffset *childOffsets);
\ No newline at end of file
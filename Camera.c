@@ -26,22 +26,30 @@ void CameraUpdate(Camera *camera, Cursor *cursor, Block *rootBlock, float deltaT
     float width = camera->width / camera->zoom;
     float height = camera->height / camera->zoom;
 
+    int32_t rootBlockX, rootBlockY;
+    BlockGetGlobalPosition(rootBlock, &rootBlockX, &rootBlockY);
+    int32_t rootBlockWidth, rootBlockHeight;
+    BlockGetSize(rootBlock, &rootBlockWidth, &rootBlockHeight);
+
     float targetX = -BlockPaddingX * 2.0f;
-    targetX = MathFloatMin(targetX, rootBlock->x + rootBlock->width * 0.5f - width * 0.5f);
+    targetX = MathFloatMin(targetX, rootBlockX + rootBlockWidth * 0.5f - width * 0.5f);
 
     int32_t cursorBlockGlobalX = 0;
     int32_t cursorBlockGlobalY = 0;
     BlockGetGlobalPosition(cursor->block, &cursorBlockGlobalX, &cursorBlockGlobalY);
 
+    int32_t cursorBlockWidth, cursorBlockHeight;
+    BlockGetSize(cursor->block, &cursorBlockWidth, &cursorBlockHeight);
+
     float targetY = cursorBlockGlobalY - height * 0.5f;
 
-    if (cursor->block->height > height)
+    if (cursorBlockHeight > height)
     {
         targetY += textHeight * 0.5f;
     }
     else
     {
-        targetY += cursor->block->height * 0.5f;
+        targetY += cursorBlockHeight * 0.5f;
     }
 
     if (camera->needsTeleport)
@@ -54,9 +62,14 @@ void CameraUpdate(Camera *camera, Cursor *cursor, Block *rootBlock, float deltaT
 
     const float stopDistance = 1.0f;
 
+    float lastX = camera->x;
+    float lastY = camera->y;
+
     float delta = PanSpeed * deltaTime;
     camera->x = MathLazyLerp(camera->x, targetX, delta, stopDistance);
     camera->y = MathLazyLerp(camera->y, targetY, delta, stopDistance);
+
+    camera->isMoving = camera->x != lastX || camera->y != lastY;
 }
 
 void CameraZoomIn(Camera *camera)
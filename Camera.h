@@ -15,6 +15,7 @@ typedef struct Camera
     float zoom;
 
     bool needsTeleport;
+    bool isMoving;
 } Camera;
 
 Camera CameraNew(void);
@@ -5,6 +5,8 @@
 #include <GLFW/glfw3.h>
 
 static const float AnimationSpeed = 30.0f;
+// The cursor snaps to it's target once it's this close, so that the animation can finish.
+static const float AnimationStopDistance = 0.1f;
 
 Cursor CursorNew(Block *block)
 {
@@ -168,10 +170,8 @@ static void CommandUndo(Cursor *cursor, Command *command)
         break;
     }
     case CommandKindSwap: {
-        BlockParentData *parentData = &command->data.swap.parent->data.parent;
-
-        BlockMarkNeedsUpdate(parentData->children.data[command->data.swap.firstChildI]);
-        BlockMarkNeedsUpdate(parentData->children.data[command->data.swap.secondChildI]);
+        BlockMarkNeedsUpdate(BlockGetChild(command->data.swap.parent, command->data.swap.firstChildI));
+        BlockMarkNeedsUpdate(BlockGetChild(command->data.swap.parent, command->data.swap.secondChildI));
 
         BlockSwapChildren(command->data.swap.parent, command->data.swap.firstChildI, command->data.swap.secondChildI);
 
@@ -338,7 +338,7 @@ static void CursorStartInsert(Cursor *cursor, InsertDirection insertDirection)
 
     if (parent && !defaultChildKind->isPin)
     {
-        Block *block = BlockNew(defaultChildKind->blockKindId, parent, childI);
+        Block *block = BlockNew(parent->arena, defaultChildKind->blockKindId, parent, childI);
         CursorAddChild(cursor, parent, block, childI);
         CursorEndInsert(cursor);
 
@@ -379,7 +379,7 @@ static void CursorCopy(Cursor *cursor)
         BlockDelete(cursor->clipboardBlock);
     }
 
-    cursor->clipboardBlock = BlockCopy(cursor->block, NULL, 0);
+    cursor->clipboardBlock = BlockCopy(cursor->block->arena, cursor->block, NULL, 0);
 }
 
 static void CursorCut(Cursor *cursor)
@@ -400,7 +400,8 @@ static void CursorPaste(Cursor *cursor)
         return;
     }
 
-    Block *pastedBlock = BlockCopy(cursor->clipboardBlock, cursor->block->parent, cursor->block->childI);
+    Block *pastedBlock =
+        BlockCopy(cursor->block->arena, cursor->clipboardBlock, cursor->block->parent, cursor->block->childI);
 
     BlockMarkNeedsUpdate(cursor->block);
 
@@ -572,14 +573,14 @@ static bool CursorFindMatchingResult(
         return false;
     }
 
-    Block *block = BlockNew(kindId, parent, childI);
+    Block *block = BlockNew(parent->arena, kindId, parent, childI);
     CursorAddChild(cursor, parent, block, childI);
     CursorEndInsert(cursor);
 
     return true;
 }
 
-static void CursorUpdateInsert(Cursor *cursor, Input *input, Font *font)
+static void CursorUpdateInsert(Cursor *cursor, Input *input)
 {
     int32_t childI;
     CursorGetChildInsertIndexInDirection(cursor, &childI);
@@ -603,7 +604,7 @@ static void CursorUpdateInsert(Cursor *cursor, Input *input, Font *font)
     {
         if (cursor->searchBar.text.count == 0 && defaultChildKind->isPin)
         {
-            Block *block = BlockNew(BlockKindIdPin, parent, childI);
+            Block *block = BlockNew(parent->arena, BlockKindIdPin, parent, childI);
             CursorAddChild(cursor, parent, block, childI);
             CursorEndInsert(cursor);
 
@@ -618,8 +619,8 @@ static void CursorUpdateInsert(Cursor *cursor, Input *input, Font *font)
 
         if (BlockCanPinKindContainBlockKind(BlockKindIdIdentifier, defaultChildKind->pinKind))
         {
-            Block *block =
-                BlockNewIdentifier(cursor->searchBar.text.data, cursor->searchBar.text.count, font, parent, childI);
+            Block *block = BlockNewIdentifier(
+                parent->arena, cursor->searchBar.text.data, cursor->searchBar.text.count, parent, childI);
             CursorAddChild(cursor, parent, block, childI);
             CursorEndInsert(cursor);
 
@@ -635,7 +636,7 @@ static void CursorUpdateInsert(Cursor *cursor, Input *input, Font *font)
     }
 }
 
-void CursorUpdate(Cursor *cursor, Input *input, Font *font)
+void CursorUpdate(Cursor *cursor, Input *input)
 {
     switch (cursor->state)
     {
@@ -644,7 +645,7 @@ void CursorUpdate(Cursor *cursor, Input *input, Font *font)
         break;
     }
     case CursorStateInsert: {
-        CursorUpdateInsert(cursor, input, font);
+        CursorUpdateInsert(cursor, input);
         break;
     }
     }
@@ -670,8 +671,11 @@ void CursorDraw(Cursor *cursor, Camera *camera, Font *font, Theme *theme, float
 
     float targetX = blockGlobalX - BlockPaddingX - LineWidth;
     float targetY = blockGlobalY - BlockPaddingY - LineWidth;
-    float targetWidth = block->width + LineWidth * 2;
-    float targetHeight = block->height + LineWidth * 2;
+    int32_t blockWidth, blockHeight;
+    BlockGetSize(block, &blockWidth, &blockHeight);
+
+    float targetWidth = blockWidth + LineWidth * 2;
+    float targetHeight = blockHeight + LineWidth * 2;
 
     if (cursor->isFirstDraw)
     {
@@ -689,6 +693,19 @@ void CursorDraw(Cursor *cursor, Camera *camera, Font *font, Theme *theme, float
     cursor->width = MathLerp(cursor->width, targetWidth, delta);
     cursor->height = MathLerp(cursor->height, targetHeight, delta);
 
+    cursor->isAnimating = MathFloatAbs(targetX - cursor->x) > AnimationStopDistance ||
+                          MathFloatAbs(targetY - cursor->y) > AnimationStopDistance ||
+                          MathFloatAbs(targetWidth - cursor->width) > AnimationStopDistance ||
+                          MathFloatAbs(targetHeight - cursor->height) > AnimationStopDistance;
+
+    if (!cursor->isAnimating)
+    {
+        cursor->x = targetX;
+        cursor->y = targetY;
+        cursor->width = targetWidth;
+        cursor->height = targetHeight;
+    }
+
     switch (cursor->state)
     {
     case CursorStateMove: {
@@ -796,17 +813,15 @@ void CursorDeleteHere(Cursor *cursor)
     BlockDeleteResult deleteResult = CommandDeleteChild(cursor, parent, childI);
     BlockMarkNeedsUpdate(parent);
 
-    BlockParentData *parentParentData = &parent->data.parent;
-
     if (deleteResult.wasRemoved)
     {
-        if (childI < parentParentData->children.count)
+        if (childI < BlockGetChildrenCount(parent))
         {
-            cursor->block = parentParentData->children.data[childI];
+            cursor->block = BlockGetChild(parent, childI);
         }
         else if (childI > 0)
         {
-            cursor->block = parentParentData->children.data[childI - 1];
+            cursor->block = BlockGetChild(parent, childI - 1);
         }
         else
         {
@@ -815,6 +830,6 @@ void CursorDeleteHere(Cursor *cursor)
     }
     else
     {
-        cursor->block = parentParentData->children.data[childI];
+        cursor->block = BlockGetChild(parent, childI);
     }
 }
\ No newline at end of file
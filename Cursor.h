@@ -91,11 +91,12 @@ typedef struct Cursor
     float height;
 
     bool isFirstDraw;
+    bool isAnimating;
 } Cursor;
 
 Cursor CursorNew(Block *block);
 void CursorDelete(Cursor *cursor);
-void CursorUpdate(Cursor *cursor, Input *input, Font *font);
+void CursorUpdate(Cursor *cursor, Input *input);
 void CursorDraw(Cursor *cursor, Camera *camera, Font *font, Theme *theme, float deltaTime);
 void CursorAscend(Cursor *cursor);
 void CursorDescend(Cursor *cursor);
@@ -1,9 +1,12 @@
 #include "Font.h"
+#include "List.h"
+#include "Profiler.h"
+#include "Tracer.h"
 
 #include <sokol_gfx.h>
 #include <sokol_log.h>
 
-#define GLFW_INCLUDE_NONE
+// GLFW includes the system's OpenGL header, which is used to upload parts of the atlas.
 #include "GLFW/glfw3.h"
 
 #include "sokol_gp.h"
@@ -18,6 +21,15 @@
 #define INIT_NUM_FONTITEMS 10
 #endif
 
+#ifndef FONT_ATLAS_MAX_PAGES
+#define FONT_ATLAS_MAX_PAGES 4
+#endif
+
+// Glyphs that haven't been drawn for this many frames are evicted first once the atlas is full.
+#ifndef FONT_GLYPH_IDLE_FRAMES
+#define FONT_GLYPH_IDLE_FRAMES 60
+#endif
+
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,34 +37,102 @@
 
 int32_t fonsAddFontMem(FONScontext *stash, const char *name, unsigned char *data, int32_t dataSize, int32_t freeData);
 
+static const int32_t FontGlyphRectsInitialCapacity = 1024;
+
+ListDefine(sgp_textured_rect);
+
+// The atlas only stores coverage, the text color is applied by this shader.
+static const char *FontVertexSource =
+    "#version 330\n"
+    "layout(location = 0) in vec4 coord;\n"
+    "layout(location = 1) in vec4 color;\n"
+    "out vec2 uv;\n"
+    "out vec4 fragmentColor;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(coord.xy, 0.0, 1.0);\n"
+    "    uv = coord.zw;\n"
+    "    fragmentColor = color;\n"
+    "}\n";
+
+#ifdef FONT_SDF
+// The atlas stores distances to the glyph's outline, with the outline itself at 0.5.
+// Coverage is found by smoothing across the outline over about one pixel, at any scale.
+static const char *FontFragmentSource =
+    "#version 330\n"
+    "uniform sampler2D atlas;\n"
+    "in vec2 uv;\n"
+    "in vec4 fragmentColor;\n"
+    "out vec4 outputColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float distance = texture(atlas, uv).r;\n"
+    "    float smoothing = fwidth(distance) * 0.5;\n"
+    "    float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n"
+    "    outputColor = vec4(fragmentColor.rgb, fragmentColor.a * coverage);\n"
+    "}\n";
+#else
+static const char *FontFragmentSource =
+    "#version 330\n"
+    "uniform sampler2D atlas;\n"
+    "in vec2 uv;\n"
+    "in vec4 fragmentColor;\n"
+    "out vec4 outputColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float coverage = texture(atlas, uv).r;\n"
+    "    outputColor = vec4(fragmentColor.rgb, fragmentColor.a * coverage);\n"
+    "}\n";
+#endif
+
 // Font handling ported from Lyte2D.
+// Glyphs are queued as they're drawn and submitted together when the font is flushed.
 typedef struct Font
 {
+    List_sgp_textured_rect glyphRects;
     FONScontext *context;
-    void *data;
-    uint8_t *buffer;
     sg_image image;
     sg_sampler sampler;
+    sg_shader shader;
+    sg_pipeline pipeline;
+
+    // The atlas is made of square pages stacked vertically, so that all glyphs can still be drawn at once.
+    // When it's full and can't grow any further, the least recently used glyphs are evicted at the end of the frame.
+    int32_t pageCount;
+    bool needsEviction;
+
     int32_t width;
     int32_t height;
     int32_t id;
     int32_t atlasDimensions;
     float size;
-    bool needsUpdate;
+    // Glyphs are drawn scaled by this much, which is only useful when they're distance fields.
+    float drawScale;
+    float lineHeight;
+
+    // Text is measured without fontstash, so that measuring never changes the atlas.
+    FontMetrics *metrics;
 } Font;
 
+// The image is created once with room for every page, so growing the atlas never replaces it while glyphs using it
+// are still waiting to be drawn. It's immutable so that it only has a single texture, which is then updated in place.
 static int32_t FontStashRenderCreate(void *user, int32_t width, int32_t height)
 {
     Font *font = (Font *)user;
     font->width = width;
     font->height = height;
 
+    int32_t imageHeight = height * FONT_ATLAS_MAX_PAGES;
+    uint8_t *emptyData = calloc((size_t)width * imageHeight, 1);
+    assert(emptyData);
+
     sg_image_desc imageDescriptor = (sg_image_desc){
         .width = width,
-        .height = height,
-        .pixel_format = SG_PIXELFORMAT_RGBA8,
+        .height = imageHeight,
+        .pixel_format = SG_PIXELFORMAT_R8,
         .type = SG_IMAGETYPE_2D,
-        .usage = SG_USAGE_DYNAMIC,
+        .usage = SG_USAGE_IMMUTABLE,
+        .data.subimage[0][0] = {.ptr = emptyData, .size = (size_t)width * imageHeight},
     };
 
     sg_sampler_desc samplerDescriptor = (sg_sampler_desc){
@@ -62,7 +142,9 @@ static int32_t FontStashRenderCreate(void *user, int32_t width, int32_t height)
 
     font->image = sg_make_image(&imageDescriptor);
     font->sampler = sg_make_sampler(&samplerDescriptor);
-    font->buffer = malloc(width * height * 4);
+
+    free(emptyData);
+
     return 1;
 }
 
@@ -72,38 +154,21 @@ static void FontStashRenderDelete(void *user)
     sg_destroy_image(font->image);
     sg_destroy_sampler(font->sampler);
     font->image = (sg_image){0};
-    free(font->buffer);
 }
 
+// Pages are only ever added below the existing ones, so glyphs keep their positions in the image.
 static int32_t FontStashRenderResize(void *user, int32_t width, int32_t height)
-{
-    FontStashRenderDelete(user);
-
-    return FontStashRenderCreate(user, width, height);
-}
-
-static void FontStashRenderUpdate(void *user, int32_t *rectangle, const uint8_t *data)
 {
     Font *font = (Font *)user;
 
-    int32_t x1 = rectangle[0];
-    int32_t y1 = rectangle[1];
-    int32_t x2 = rectangle[2];
-    int32_t y2 = rectangle[3];
-
-    for (int32_t iy = y1; iy < y2; iy++)
+    if (width != font->width || height > font->atlasDimensions * FONT_ATLAS_MAX_PAGES)
     {
-        for (int32_t ix = x1; ix < x2; ix++)
-        {
-            int32_t i = ix + iy * font->width;
-            font->buffer[i * 4] = (uint8_t)255;
-            font->buffer[i * 4 + 1] = (uint8_t)255;
-            font->buffer[i * 4 + 2] = (uint8_t)255;
-            font->buffer[i * 4 + 3] = data[i];
-        }
+        return 0;
     }
 
-    font->needsUpdate = true;
+    font->height = height;
+
+    return 1;
 }
 
 static void FontStashRenderDraw(
@@ -113,55 +178,67 @@ static void FontStashRenderDraw(
 
     Font *font = (Font *)user;
 
-    int32_t width = font->width;
-    int32_t height = font->height;
-
-    sgp_set_image(0, font->image);
-    sgp_set_sampler(0, font->sampler);
+    float width = (float)font->width;
+    float height = (float)font->height;
+    float scale = font->drawScale;
 
-    sgp_set_blend_mode(SGP_BLENDMODE_BLEND);
-
-    for (int32_t i = 0; i < vertexCount - 2; i += 3)
+    // Each glyph is made of two triangles, the first starts at the glyph's top left corner and the second vertex
+    // is at it's bottom right corner.
+    for (int32_t i = 0; i < vertexCount - 5; i += 6)
     {
-        int32_t q = 0;
-        float x1 = vertices[(q + i) * 2];
-        float y1 = vertices[(q + i) * 2 + 1];
-        float u1 = uvs[(q + i) * 2];
-        float v1 = uvs[(q + i) * 2 + 1];
-        q += 2;
-        float x3 = vertices[(q + i) * 2];
-        float y3 = vertices[(q + i) * 2 + 1];
-        float u3 = uvs[(q + i) * 2];
-        float v3 = uvs[(q + i) * 2 + 1];
-
-        sgp_draw_textured_rect(0, (sgp_rect){x1, y1, (x3 - x1), (y3 - y1)},
-            (sgp_rect){u1 * width, v1 * height, (u3 - u1) * width, (v3 - v1) * height});
+        float x1 = vertices[i * 2];
+        float y1 = vertices[i * 2 + 1];
+        float u1 = uvs[i * 2];
+        float v1 = uvs[i * 2 + 1];
+        float x2 = vertices[(i + 1) * 2];
+        float y2 = vertices[(i + 1) * 2 + 1];
+        float u2 = uvs[(i + 1) * 2];
+        float v2 = uvs[(i + 1) * 2 + 1];
+
+        sgp_textured_rect glyphRect = {
+            .dst = {x1 * scale, y1 * scale, (x2 - x1) * scale, (y2 - y1) * scale},
+            .src = {u1 * width, v1 * height, (u2 - u1) * width, (v2 - v1) * height},
+        };
+        ListPush_sgp_textured_rect(&font->glyphRects, glyphRect);
     }
-
-    sgp_reset_image(0);
 }
 
-Font *FontNew(const char *path, float size)
+// Called by fontstash when a glyph doesn't fit, it tries to add the glyph again after this returns.
+static void FontStashHandleError(void *user, int32_t error, int32_t value)
 {
-    FILE *file = fopen(path, "rb");
-    if (!file)
+    (void)value;
+
+    Font *font = (Font *)user;
+
+    if (error != FONS_ATLAS_FULL)
     {
-        printf("Expected \"%s\"\n", path);
-        exit(EXIT_FAILURE);
+        return;
     }
 
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    uint8_t *data = malloc(fileSize);
-    fread(data, fileSize, 1, file);
-    fclose(file);
+    if (font->pageCount < FONT_ATLAS_MAX_PAGES &&
+        fonsExpandAtlas(font->context, font->atlasDimensions, font->atlasDimensions * (font->pageCount + 1)))
+    {
+        font->pageCount += 1;
+        return;
+    }
+
+    // Glyphs that were already drawn this frame are still waiting to be submitted,
+    // so they can't be evicted until the frame is over. Until then, glyphs that don't fit are skipped.
+    font->needsEviction = true;
+}
+
+// The font data isn't copied, so it needs to outlive the font.
+Font *FontNew(const char *name, uint8_t *data, int32_t dataSize, float size)
+{
+    TracerBegin("FontNew");
 
     Font *font = malloc(sizeof(Font));
     *font = (Font){
+        .glyphRects = ListNew_sgp_textured_rect(FontGlyphRectsInitialCapacity),
         .atlasDimensions = FONT_ATLAS_SIZE,
+        .pageCount = 1,
         .size = size,
-        .data = data,
+        .drawScale = 1.0f,
     };
 
     FONSparams params = {
@@ -172,11 +249,48 @@ Font *FontNew(const char *path, float size)
         .renderCreate = FontStashRenderCreate,
         .renderDelete = FontStashRenderDelete,
         .renderResize = FontStashRenderResize,
-        .renderUpdate = FontStashRenderUpdate,
         .renderDraw = FontStashRenderDraw,
     };
     font->context = fonsCreateInternal(&params);
-    font->id = fonsAddFontMem(font->context, path, data, fileSize, false);
+    font->id = fonsAddFontMem(font->context, name, data, dataSize, false);
+    fonsSetErrorCallback(font->context, FontStashHandleError, font);
+
+    // Nothing else uses the font's context, so it's state only needs to be set once.
+    fonsClearState(font->context);
+    fonsSetFont(font->context, font->id);
+    fonsSetSize(font->context, font->size);
+    fonsVertMetrics(font->context, NULL, NULL, &font->lineHeight);
+
+    if (font->id != FONS_INVALID)
+    {
+        font->metrics = FontMetricsNew(font->context, font->size);
+    }
+
+    sg_shader_desc shaderDescriptor = (sg_shader_desc){
+        .attrs =
+            {
+                [0].name = "coord",
+                [1].name = "color",
+            },
+        .vs.source = FontVertexSource,
+        .fs =
+            {
+                .source = FontFragmentSource,
+                .images[0] = {.used = true, .image_type = SG_IMAGETYPE_2D, .sample_type = SG_IMAGESAMPLETYPE_FLOAT},
+                .samplers[0] = {.used = true, .sampler_type = SG_SAMPLERTYPE_FILTERING},
+                .image_sampler_pairs[0] = {.used = true, .image_slot = 0, .sampler_slot = 0, .glsl_name = "atlas"},
+            },
+    };
+    font->shader = sg_make_shader(&shaderDescriptor);
+
+    sgp_pipeline_desc pipelineDescriptor = (sgp_pipeline_desc){
+        .shader = font->shader,
+        .blend_mode = SGP_BLENDMODE_BLEND,
+        .has_vs_color = true,
+    };
+    font->pipeline = sgp_make_pipeline(&pipelineDescriptor);
+
+    TracerEnd("FontNew");
 
     return font;
 }
@@ -188,25 +302,113 @@ int32_t FontDelete(Font *font)
         return 0;
     }
 
-    free(font->data);
+    FontMetricsDelete(font->metrics);
     fonsDeleteInternal(font->context);
+    sg_destroy_pipeline(font->pipeline);
+    sg_destroy_shader(font->shader);
+    ListDelete_sgp_textured_rect(&font->glyphRects);
     free(font);
 
     return 0;
 }
 
+// Uploads the part of the atlas that changed since the last update, rather than the whole image.
+// Sokol can only replace images in full, so the upload is done through OpenGL directly.
 void FontUpdate(Font *font)
 {
-    if (!font->needsUpdate)
+    ProfilerCount(ProfilerCounterAtlasPages, font->pageCount);
+
+    int32_t dirtyRect[4];
+
+    if (!fonsValidateTexture(font->context, dirtyRect))
+    {
+        return;
+    }
+
+    int32_t atlasWidth, atlasHeight;
+    const uint8_t *atlasData = fonsGetTextureData(font->context, &atlasWidth, &atlasHeight);
+
+    int32_t dirtyWidth = dirtyRect[2] - dirtyRect[0];
+    int32_t dirtyHeight = dirtyRect[3] - dirtyRect[1];
+    const uint8_t *dirtyData = atlasData + dirtyRect[0] + dirtyRect[1] * atlasWidth;
+
+    ProfilerCount(ProfilerCounterAtlasPixelsUploaded, dirtyWidth * dirtyHeight);
+
+    sg_gl_image_info imageInfo = sg_gl_query_image_info(font->image);
+
+    glBindTexture(GL_TEXTURE_2D, imageInfo.tex[imageInfo.active_slot]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, atlasWidth);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, dirtyRect[0], dirtyRect[1], dirtyWidth, dirtyHeight, GL_RED, GL_UNSIGNED_BYTE, dirtyData);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // Sokol caches which texture is bound, and it was just changed behind it's back.
+    sg_reset_state_cache();
+}
+
+// Submits all queued glyphs at once, using the current color and transform.
+void FontFlush(Font *font)
+{
+    int32_t glyphCount = font->glyphRects.count;
+
+    if (glyphCount == 0)
     {
         return;
     }
 
-    sg_image_data imageData = {0};
-    imageData.subimage[0][0].ptr = font->buffer, imageData.subimage[0][0].size = font->width * font->height * 4,
-    sg_update_image(font->image, &imageData);
+    ProfilerCount(ProfilerCounterGlyphsDrawn, glyphCount);
+
+    sgp_set_pipeline(font->pipeline);
+    sgp_set_image(0, font->image);
+    sgp_set_sampler(0, font->sampler);
+
+    sgp_draw_textured_rects(0, font->glyphRects.data, (uint32_t)glyphCount);
+
+    sgp_reset_image(0);
+    sgp_reset_pipeline();
+
+    ListReset_sgp_textured_rect(&font->glyphRects);
+}
+
+// Must be called after the frame has been submitted, since evicting glyphs moves the ones that are kept around.
+void FontEndFrame(Font *font)
+{
+    if (font->needsEviction)
+    {
+        TracerBegin("FontEvict");
+
+        // Glyphs that were drawn this frame are only evicted when nothing older is left.
+        int32_t evictedCount = fonsEvictGlyphs(font->context, FONT_GLYPH_IDLE_FRAMES);
+
+        if (evictedCount == 0)
+        {
+            evictedCount = fonsEvictGlyphs(font->context, 0);
+        }
+
+        ProfilerCount(ProfilerCounterGlyphsEvicted, evictedCount);
+        font->needsEviction = false;
+
+        TracerEnd("FontEvict");
+    }
+
+    ProfilerCount(ProfilerCounterGlyphsRasterized, fonsNextFrame(font->context));
+}
+
+float FontGetSize(Font *font)
+{
+    return font->size;
+}
+
+// The metrics outlive any changes to the font's atlas, and can be used from any thread until the font is deleted.
+const FontMetrics *FontGetMetrics(Font *font)
+{
+    return font->metrics;
+}
 
-    font->needsUpdate = false;
+void FontSetDrawScale(Font *font, float drawScale)
+{
+    font->drawScale = drawScale;
 }
 
 int32_t FontDraw(const char *text, float x, float y, Font *font)
@@ -216,6 +418,12 @@ int32_t FontDraw(const char *text, float x, float y, Font *font)
         return 0;
     }
 
+    return FontDrawSpan(text, (int32_t)strlen(text), x, y, font);
+}
+
+// Draws text that isn't null terminated.
+int32_t FontDrawSpan(const char *text, int32_t textLength, float x, float y, Font *font)
+{
     if (!font)
     {
         fprintf(stderr, "No font set.\n");
@@ -228,14 +436,8 @@ int32_t FontDraw(const char *text, float x, float y, Font *font)
         return -2;
     }
 
-    fonsClearState(font->context);
-    fonsSetFont(font->context, font->id);
-    fonsSetSize(font->context, font->size);
-
-    float fontHeight = 0.0;
-    fonsVertMetrics(font->context, NULL, NULL, &fontHeight);
-    fonsSetBlur(font->context, 0);
-    fonsDrawText(font->context, x, y + fontHeight, text, NULL);
+    // Text is laid out at the font's size, and then scaled to the position it was drawn at.
+    fonsDrawText(font->context, x / font->drawScale, y / font->drawScale + font->lineHeight, text, text + textLength);
 
     return 0;
 }
@@ -248,35 +450,7 @@ int32_t FontGetTextSize(
         return -1;
     }
 
-    float fonsWidth;
-    float fonsHeight;
-    float fonsAscent;
-    float fonsDescent;
-    fonsClearState(font->context);
-    fonsSetFont(font->context, font->id);
-    fonsSetSize(font->context, font->size);
-    fonsWidth = fonsTextBounds(font->context, 0, 0, text, text + strlen(text), NULL);
-    fonsVertMetrics(font->context, &fonsAscent, &fonsDescent, &fonsHeight);
-
-    if (width)
-    {
-        *width = (int32_t)fonsWidth;
-    }
-
-    if (height)
-    {
-        *height = (int32_t)fonsHeight;
-    }
-
-    if (ascent)
-    {
-        *ascent = (int32_t)fonsAscent;
-    }
-
-    if (descent)
-    {
-        *descent = (int32_t)fonsDescent;
-    }
+    FontMetricsGetTextSize(font->metrics, text, (int32_t)strlen(text), width, height, ascent, descent);
 
     return 0;
 }
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 
+#include "FontMetrics.h"
+
 #include <inttypes.h>
 
 typedef struct Font Font;
 
-Font *FontNew(const char *path, float size);
-int FontDelete(Font *font);
+Font *FontNew(const char *name, uint8_t *data, int32_t dataSize, float size);
+int32_t FontDelete(Font *font);
 void FontUpdate(Font *font);
-int FontDraw(const char *text, float x, float y, Font *font);
+void FontFlush(Font *font);
+void FontEndFrame(Font *font);
+float FontGetSize(Font *font);
+const FontMetrics *FontGetMetrics(Font *font);
+void FontSetDrawScale(Font *font, float drawScale);
+int32_t FontDraw(const char *text, float x, float y, Font *font);
+int32_t FontDrawSpan(const char *text, int32_t textLength, float x, float y, Font *font);
 int32_t FontGetTextSize(
     const char *text, int32_t *width, int32_t *height, int32_t *ascent, int32_t *descent, Font *font);
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "FontCache.h"
+#include "Math.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Sizes closer together than this share a font.
+static const float FontCacheSizeStep = 0.5f;
+// Distance fields are rasterized large, so that they hold enough detail to be scaled up smoothly.
+static const float FontCacheSdfSize = 48.0f;
+
+static float FontCacheQuantizeSize(float size)
+{
+    return MathFloatFloor(size / FontCacheSizeStep + 0.5f) * FontCacheSizeStep;
+}
+
+FontCache FontCacheNew(const char *path, float baseSize)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        printf("Expected \"%s\"\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *data = malloc(fileSize);
+    assert(data);
+    fread(data, fileSize, 1, file);
+    fclose(file);
+
+    baseSize = FontCacheQuantizeSize(baseSize);
+
+    FontCache cache = (FontCache){
+        .path = path,
+        .data = data,
+        .dataSize = (int32_t)fileSize,
+        .baseFont = FontNew(path, data, (int32_t)fileSize, baseSize),
+        .baseSize = baseSize,
+    };
+
+#ifdef FONT_SDF
+    cache.sdfFont = FontNew(path, data, (int32_t)fileSize, FontCacheSdfSize);
+#endif
+
+    return cache;
+}
+
+void FontCacheDelete(FontCache *cache)
+{
+    for (int32_t i = 0; i < FONT_CACHE_CAPACITY; i++)
+    {
+        FontDelete(cache->entries[i].font);
+    }
+
+    FontDelete(cache->sdfFont);
+    FontDelete(cache->baseFont);
+    free(cache->data);
+}
+
+Font *FontCacheGet(FontCache *cache, float size)
+{
+    if (cache->sdfFont)
+    {
+        FontSetDrawScale(cache->sdfFont, size / FontCacheSdfSize);
+
+        return cache->sdfFont;
+    }
+
+    size = FontCacheQuantizeSize(size);
+
+    if (size == cache->baseSize)
+    {
+        return cache->baseFont;
+    }
+
+    cache->useCount += 1;
+
+    FontCacheEntry *leastRecentEntry = &cache->entries[0];
+
+    for (int32_t i = 0; i < FONT_CACHE_CAPACITY; i++)
+    {
+        FontCacheEntry *entry = &cache->entries[i];
+
+        if (entry->font && entry->size == size)
+        {
+            entry->lastUsed = cache->useCount;
+
+            return entry->font;
+        }
+
+        // Empty entries have never been used, so they're picked before any others.
+        if (entry->lastUsed < leastRecentEntry->lastUsed)
+        {
+            leastRecentEntry = entry;
+        }
+    }
+
+    FontDelete(leastRecentEntry->font);
+
+    *leastRecentEntry = (FontCacheEntry){
+        .font = FontNew(cache->path, cache->data, cache->dataSize, size),
+        .size = size,
+        .lastUsed = cache->useCount,
+    };
+
+    return leastRecentEntry->font;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Font.h"
+
+#include <inttypes.h>
+
+#define FONT_CACHE_CAPACITY 4
+
+typedef struct FontCacheEntry
+{
+    Font *font;
+    float size;
+    uint64_t lastUsed;
+} FontCacheEntry;
+
+// Loads a font file once, and keeps recently used sizes of it around so that switching between them is free.
+typedef struct FontCache
+{
+    const char *path;
+    uint8_t *data;
+    int32_t dataSize;
+
+    // The base font is used for layout, so it's kept out of the LRU and never evicted.
+    Font *baseFont;
+    float baseSize;
+
+    // When text is drawn from distance fields, every size is drawn by scaling this one font instead.
+    Font *sdfFont;
+
+    FontCacheEntry entries[FONT_CACHE_CAPACITY];
+    uint64_t useCount;
+} FontCache;
+
+FontCache FontCacheNew(const char *path, float baseSize);
+void FontCacheDelete(FontCache *cache);
+Font *FontCacheGet(FontCache *cache, float size);
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "FontMetrics.h"
+#include "List.h"
+#include "Tracer.h"
+
+#include "fontstash.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Characters below this have their advances stored in a table, which covers most alphabets, punctuation and symbols.
+// Others, such as CJK and emoji, are looked up in a sorted list of the ones the font has glyphs for.
+#ifndef FONT_METRICS_CODEPOINT_COUNT
+#define FONT_METRICS_CODEPOINT_COUNT 0x3000
+#endif
+
+#define FONT_METRICS_ASCII_COUNT 128
+static const uint8_t FontMetricsAsciiFirst = ' ';
+static const uint8_t FontMetricsAsciiLast = '~';
+
+typedef struct FontMetricsCodepointAdvance
+{
+    uint32_t codepoint;
+    int16_t advance;
+} FontMetricsCodepointAdvance;
+
+ListDefine(FontMetricsCodepointAdvance);
+
+typedef struct FontMetrics
+{
+    float size;
+    float ascent;
+    float descent;
+    float lineHeight;
+
+    // Indexed by codepoint, fontstash's advances are whole pixels so they add up exactly.
+    int16_t advances[FONT_METRICS_CODEPOINT_COUNT];
+    int16_t missingAdvance;
+    // Characters past the table, sorted by codepoint. Ones with the same advance as the missing glyph are left out.
+    List_FontMetricsCodepointAdvance highAdvances;
+
+    // Indexed by the previous and then current character, only pairs of printable ASCII characters are kerned.
+    int8_t asciiKerning[FONT_METRICS_ASCII_COUNT][FONT_METRICS_ASCII_COUNT];
+    bool hasAsciiKerning;
+} FontMetrics;
+
+// Measures each pair of printable characters with fontstash, which adds those characters to the atlas.
+static void FontMetricsBuildAsciiKerning(FontMetrics *metrics, FONScontext *context)
+{
+    char text[3] = {0};
+
+    for (int32_t i = FontMetricsAsciiFirst; i <= FontMetricsAsciiLast; i++)
+    {
+        for (int32_t j = FontMetricsAsciiFirst; j <= FontMetricsAsciiLast; j++)
+        {
+            text[0] = (char)i;
+            text[1] = (char)j;
+            int32_t pairWidth = (int32_t)fonsTextBounds(context, 0, 0, text, text + 2, NULL);
+            int32_t kerning = pairWidth - metrics->advances[i] - metrics->advances[j];
+
+            assert(kerning >= INT8_MIN && kerning <= INT8_MAX);
+
+            metrics->asciiKerning[i][j] = (int8_t)kerning;
+            metrics->hasAsciiKerning = metrics->hasAsciiKerning || kerning != 0;
+        }
+    }
+}
+
+// Decodes the codepoint starting at the given byte, and moves past it. Invalid bytes are skipped.
+static uint32_t FontMetricsDecodeUtf8(const uint8_t **bytes, const uint8_t *end)
+{
+    const uint8_t *current = *bytes;
+    uint32_t codepoint = *current;
+    int32_t continuationCount = 0;
+
+    if (codepoint >= 0xF0 && codepoint < 0xF8)
+    {
+        codepoint &= 0x07;
+        continuationCount = 3;
+    }
+    else if (codepoint >= 0xE0)
+    {
+        codepoint &= 0x0F;
+        continuationCount = 2;
+    }
+    else if (codepoint >= 0xC0)
+    {
+        codepoint &= 0x1F;
+        continuationCount = 1;
+    }
+
+    current++;
+
+    for (int32_t i = 0; i < continuationCount && current < end; i++)
+    {
+        if ((*current & 0xC0) != 0x80)
+        {
+            break;
+        }
+
+        codepoint = (codepoint << 6) | (*current & 0x3F);
+        current++;
+    }
+
+    *bytes = current;
+
+    return codepoint;
+}
+
+static int32_t FontMetricsGetAdvance(const FontMetrics *metrics, uint32_t codepoint)
+{
+    if (codepoint < FONT_METRICS_CODEPOINT_COUNT)
+    {
+        return metrics->advances[codepoint];
+    }
+
+    const FontMetricsCodepointAdvance *highAdvances = metrics->highAdvances.data;
+    int32_t low = 0;
+    int32_t high = metrics->highAdvances.count;
+
+    while (low < high)
+    {
+        int32_t middle = low + (high - low) / 2;
+
+        if (highAdvances[middle].codepoint < codepoint)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low < metrics->highAdvances.count && highAdvances[low].codepoint == codepoint)
+    {
+        return highAdvances[low].advance;
+    }
+
+    return metrics->missingAdvance;
+}
+
+// Used once text has been found to contain characters outside of ASCII.
+static int32_t FontMetricsGetUtf8TextWidth(const FontMetrics *metrics, const char *text, int32_t textLength)
+{
+    const uint8_t *bytes = (const uint8_t *)text;
+    const uint8_t *end = bytes + textLength;
+    int32_t textWidth = 0;
+    uint32_t previous = 0;
+
+    while (bytes < end)
+    {
+        bool isInvalid = (*bytes & 0xC0) == 0x80 || *bytes >= 0xF8;
+        uint32_t current = FontMetricsDecodeUtf8(&bytes, end);
+
+        if (isInvalid)
+        {
+            continue;
+        }
+
+        textWidth += FontMetricsGetAdvance(metrics, current);
+
+        if (previous < FONT_METRICS_ASCII_COUNT && current < FONT_METRICS_ASCII_COUNT)
+        {
+            textWidth += metrics->asciiKerning[previous][current];
+        }
+
+        previous = current;
+    }
+
+    return textWidth;
+}
+
+// Whether or not the text is all ASCII is only checked once at the end, so the loop has no branches.
+static int32_t FontMetricsGetTextWidth(const FontMetrics *metrics, const char *text, int32_t textLength)
+{
+    const uint8_t *bytes = (const uint8_t *)text;
+    int32_t textWidth = 0;
+    bool isOutOfRange = false;
+
+    if (metrics->hasAsciiKerning)
+    {
+        // The first character's kerning comes from the row of the null character, which is all zeroes.
+        uint8_t previous = 0;
+
+        for (int32_t i = 0; i < textLength; i++)
+        {
+            uint8_t current = bytes[i];
+            isOutOfRange |= current >= FONT_METRICS_ASCII_COUNT;
+            current &= FONT_METRICS_ASCII_COUNT - 1;
+
+            textWidth += metrics->advances[current] + metrics->asciiKerning[previous][current];
+            previous = current;
+        }
+    }
+    else
+    {
+        for (int32_t i = 0; i < textLength; i++)
+        {
+            uint8_t current = bytes[i];
+            isOutOfRange |= current >= FONT_METRICS_ASCII_COUNT;
+
+            textWidth += metrics->advances[current & (FONT_METRICS_ASCII_COUNT - 1)];
+        }
+    }
+
+    if (isOutOfRange)
+    {
+        return FontMetricsGetUtf8TextWidth(metrics, text, textLength);
+    }
+
+    return textWidth;
+}
+
+// Measures the context's current font at the given size, which must be the context's current size.
+// Only printable ASCII characters are added to the atlas, every other advance is read from the font directly.
+FontMetrics *FontMetricsNew(FONScontext *context, float size)
+{
+    TracerBegin("FontMetricsNew");
+
+    FontMetrics *metrics = malloc(sizeof(FontMetrics));
+    assert(metrics);
+    *metrics = (FontMetrics){
+        .size = size,
+    };
+
+    fonsVertMetrics(context, &metrics->ascent, &metrics->descent, &metrics->lineHeight);
+
+    for (uint32_t i = 0; i < FONT_METRICS_CODEPOINT_COUNT; i++)
+    {
+        metrics->advances[i] = (int16_t)fonsCodepointAdvance(context, i);
+    }
+
+    // Past the end of the Unicode range, so it's guaranteed to be missing from the font.
+    metrics->missingAdvance = (int16_t)fonsCodepointAdvance(context, 0x110000);
+
+    // The font's characters are visited in order, so the list ends up sorted.
+    metrics->highAdvances = ListNew_FontMetricsCodepointAdvance(64);
+    uint32_t codepoint = FONT_METRICS_CODEPOINT_COUNT - 1;
+
+    while ((codepoint = fonsNextCodepoint(context, codepoint)) != 0)
+    {
+        int16_t advance = (int16_t)fonsCodepointAdvance(context, codepoint);
+
+        if (advance != metrics->missingAdvance)
+        {
+            FontMetricsCodepointAdvance highAdvance = {
+                .codepoint = codepoint,
+                .advance = advance,
+            };
+
+            ListPush_FontMetricsCodepointAdvance(&metrics->highAdvances, highAdvance);
+        }
+    }
+
+    FontMetricsBuildAsciiKerning(metrics, context);
+
+    TracerEnd("FontMetricsNew");
+
+    return metrics;
+}
+
+void FontMetricsDelete(FontMetrics *metrics)
+{
+    ListDelete_FontMetricsCodepointAdvance(&metrics->highAdvances);
+    free(metrics);
+}
+
+float FontMetricsGetSize(const FontMetrics *metrics)
+{
+    return metrics->size;
+}
+
+// The text doesn't need to be null terminated.
+void FontMetricsGetTextSize(const FontMetrics *metrics, const char *text, int32_t textLength, int32_t *width,
+    int32_t *height, int32_t *ascent, int32_t *descent)
+{
+    if (width)
+    {
+        *width = FontMetricsGetTextWidth(metrics, text, textLength);
+    }
+
+    if (height)
+    {
+        *height = (int32_t)metrics->lineHeight;
+    }
+
+    if (ascent)
+    {
+        *ascent = (int32_t)metrics->ascent;
+    }
+
+    if (descent)
+    {
+        *descent = (int32_t)metrics->descent;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <inttypes.h>
+
+typedef struct FONScontext FONScontext;
+
+// Measurements of a font at one size, all taken when it's created. Nothing in it changes afterwards,
+// and measuring text never touches the font's context or atlas, so it can be shared between threads.
+typedef struct FontMetrics FontMetrics;
+
+FontMetrics *FontMetricsNew(FONScontext *context, float size);
+void FontMetricsDelete(FontMetrics *metrics);
+float FontMetricsGetSize(const FontMetrics *metrics);
+void FontMetricsGetTextSize(const FontMetrics *metrics, const char *text, int32_t textLength, int32_t *width,
+    int32_t *height, int32_t *ascent, int32_t *descent);
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "FontMetrics.h"
+
+#define FONTSTASH_IMPLEMENTATION
+#define FONS_USE_FREETYPE
+#if defined(_MSC_VER)
+#pragma warning(disable : 4996)
+#pragma warning(disable : 4018)
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#endif
+#include "fontstash.h"
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Checks that measuring text with FontMetrics gives the same widths as laying it out with fontstash,
+ * using the FreeType backend that the editor is built with. Run by ctest.
+ * Usage: FontMetricsTest <font path>
+ */
+
+static const float TestFontSizes[] = {8, 13, 16, 17.5f, 24, 40};
+static const int32_t TestAtlasDimensions = 2048;
+// Measuring with fontstash adds glyphs to the atlas, so it's cleared before it can fill up.
+static const int32_t TestMeasurementsPerAtlas = 1024;
+static const int32_t TestRandomTextCount = 20000;
+static const int32_t TestRandomTextMaxLength = 12;
+static const uint32_t TestLastCodepoint = 0x10FFFF;
+
+typedef struct Test
+{
+    FONScontext *context;
+    const FontMetrics *metrics;
+    int32_t measurementCount;
+    int32_t mismatchCount;
+    uint32_t randomState;
+} Test;
+
+static int32_t TestEncodeUtf8(char *text, uint32_t codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        text[0] = (char)codepoint;
+        return 1;
+    }
+
+    if (codepoint < 0x800)
+    {
+        text[0] = (char)(0xC0 | (codepoint >> 6));
+        text[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+
+    if (codepoint < 0x10000)
+    {
+        text[0] = (char)(0xE0 | (codepoint >> 12));
+        text[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        text[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+
+    text[0] = (char)(0xF0 | (codepoint >> 18));
+    text[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    text[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    text[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+static void TestMeasure(Test *test, const char *text, int32_t textLength)
+{
+    if (test->measurementCount % TestMeasurementsPerAtlas == 0)
+    {
+        fonsResetAtlas(test->context, TestAtlasDimensions, TestAtlasDimensions);
+    }
+
+    test->measurementCount += 1;
+
+    int32_t width;
+    FontMetricsGetTextSize(test->metrics, text, textLength, &width, NULL, NULL, NULL);
+    int32_t expectedWidth = (int32_t)fonsTextBounds(test->context, 0, 0, text, text + textLength, NULL);
+
+    if (width != expectedWidth)
+    {
+        if (test->mismatchCount < 16)
+        {
+            printf("\"%.*s\" measured %d wide, but fontstash lays it out %d wide.\n", textLength, text, width,
+                expectedWidth);
+        }
+
+        test->mismatchCount += 1;
+    }
+}
+
+static uint32_t TestRandom(Test *test, uint32_t range)
+{
+    test->randomState = test->randomState * 1664525 + 1013904223;
+
+    return (test->randomState >> 8) % range;
+}
+
+// Mostly printable ASCII, since that's what source code is made of, with characters from the rest of the font mixed in.
+static uint32_t TestRandomCodepoint(Test *test)
+{
+    uint32_t codepoint =
+        TestRandom(test, 4) == 0 ? TestRandom(test, TestLastCodepoint + 1) : ' ' + TestRandom(test, '~' - ' ' + 1);
+
+    // Surrogates can't be encoded, and fontstash doesn't lay out null characters.
+    if (codepoint == 0 || (codepoint >= 0xD800 && codepoint < 0xE000))
+    {
+        return '?';
+    }
+
+    return codepoint;
+}
+
+static void TestSize(Test *test, float size)
+{
+    fonsSetSize(test->context, size);
+    FontMetrics *metrics = FontMetricsNew(test->context, size);
+    test->metrics = metrics;
+
+    char text[4 * 16];
+
+    // Every character the font has, along with one that it doesn't.
+    uint32_t codepoint = 0;
+
+    while ((codepoint = fonsNextCodepoint(test->context, codepoint)) != 0)
+    {
+        if (codepoint < 0xD800 || codepoint >= 0xE000)
+        {
+            TestMeasure(test, text, TestEncodeUtf8(text, codepoint));
+        }
+    }
+
+    TestMeasure(test, text, TestEncodeUtf8(text, TestLastCodepoint));
+
+    // Every pair of printable characters, which is where kerning is applied.
+    for (char first = ' '; first <= '~'; first++)
+    {
+        for (char second = ' '; second <= '~'; second++)
+        {
+            text[0] = first;
+            text[1] = second;
+            TestMeasure(test, text, 2);
+        }
+    }
+
+    for (int32_t i = 0; i < TestRandomTextCount; i++)
+    {
+        int32_t textLength = 0;
+        int32_t characterCount = (int32_t)TestRandom(test, TestRandomTextMaxLength + 1);
+
+        for (int32_t j = 0; j < characterCount; j++)
+        {
+            textLength += TestEncodeUtf8(text + textLength, TestRandomCodepoint(test));
+        }
+
+        TestMeasure(test, text, textLength);
+    }
+
+    FontMetricsDelete(metrics);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: FontMetricsTest <font path>\n");
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+
+    if (!file)
+    {
+        printf("Failed to open font: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    fseek(file, 0, SEEK_END);
+    int32_t dataSize = (int32_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = malloc((size_t)dataSize);
+    bool didRead = fread(data, 1, (size_t)dataSize, file) == (size_t)dataSize;
+    fclose(file);
+
+    if (!didRead)
+    {
+        printf("Failed to read font: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FONSparams params = {
+        .flags = FONS_ZERO_TOPLEFT,
+        .width = TestAtlasDimensions,
+        .height = TestAtlasDimensions,
+    };
+
+    Test test = {
+        .context = fonsCreateInternal(&params),
+        .randomState = 1,
+    };
+
+    int fontId = fonsAddFontMem(test.context, "Test", data, dataSize, true);
+
+    if (fontId == FONS_INVALID)
+    {
+        printf("Failed to load font: %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    fonsClearState(test.context);
+    fonsSetFont(test.context, fontId);
+
+    for (size_t i = 0; i < sizeof(TestFontSizes) / sizeof(TestFontSizes[0]); i++)
+    {
+        TestSize(&test, TestFontSizes[i]);
+    }
+
+    fonsDeleteInternal(test.context);
+
+    printf("%d of %d measurements didn't match.\n", test.mismatchCount, test.measurementCount);
+
+    return test.mismatchCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -16,6 +16,9 @@
 
 #define FONTSTASH_IMPLEMENTATION
 #define FONS_USE_FREETYPE
+#ifdef FONT_SDF
+#define FONS_FREETYPE_SDF
+#endif
 
 #if defined(_MSC_VER)
 #pragma warning(disable : 4996)
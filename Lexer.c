@@ -1,38 +1,484 @@
 #include "Lexer.h"
 
+#include <assert.h>
 #include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 
-Lexer LexerNew(char *data, int32_t dataCount)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LEXER_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LEXER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// How much of a streamed source is read at once.
+#ifndef LEXER_CHUNK_SIZE
+#define LEXER_CHUNK_SIZE (64 * 1024)
+#endif
+
+// How many tokens of a source in memory are lexed at once.
+#ifndef LEXER_TOKEN_WINDOW_SIZE
+#define LEXER_TOKEN_WINDOW_SIZE 4096
+#endif
+
+// Keywords are found with a perfect hash of their first and last characters and their length, the multipliers were
+// picked so that none of them collide.
+#define LEXER_KEYWORD_TABLE_SIZE 32
+#define LEXER_HASH_KEYWORD(first, last, length) (((first) * 3 + (last) * 25 + (length)) & (LEXER_KEYWORD_TABLE_SIZE - 1))
+#define LEXER_KEYWORD(text, first, last, kind)                                                                         \
+    [LEXER_HASH_KEYWORD(first, last, sizeof(text) - 1)] = {text, sizeof(text) - 1, kind}
+
+typedef struct LexerKeyword
+{
+    const char *text;
+    int32_t length;
+    TokenKind kind;
+} LexerKeyword;
+
+static const LexerKeyword LexerKeywords[LEXER_KEYWORD_TABLE_SIZE] = {
+    LEXER_KEYWORD("and", 'a', 'd', TokenKindAnd),
+    LEXER_KEYWORD("do", 'd', 'o', TokenKindDo),
+    LEXER_KEYWORD("else", 'e', 'e', TokenKindElse),
+    LEXER_KEYWORD("elseif", 'e', 'f', TokenKindElseif),
+    LEXER_KEYWORD("end", 'e', 'd', TokenKindEnd),
+    LEXER_KEYWORD("for", 'f', 'r', TokenKindFor),
+    LEXER_KEYWORD("function", 'f', 'n', TokenKindFunction),
+    LEXER_KEYWORD("if", 'i', 'f', TokenKindIf),
+    LEXER_KEYWORD("in", 'i', 'n', TokenKindIn),
+    LEXER_KEYWORD("local", 'l', 'l', TokenKindLocal),
+    LEXER_KEYWORD("not", 'n', 't', TokenKindNot),
+    LEXER_KEYWORD("or", 'o', 'r', TokenKindOr),
+    LEXER_KEYWORD("return", 'r', 'n', TokenKindReturn),
+    LEXER_KEYWORD("then", 't', 'n', TokenKindThen),
+    LEXER_KEYWORD("while", 'w', 'e', TokenKindWhile),
+};
+
+static const char *TokenKindNames[TokenKindCount] = {
+    [TokenKindNone] = "nothing",
+    [TokenKindEndOfFile] = "end of file",
+    [TokenKindIdentifier] = "identifier",
+    [TokenKindString] = "string",
+    [TokenKindNumber] = "number",
+    [TokenKindComment] = "comment",
+    [TokenKindOther] = "symbol",
+    [TokenKindAnd] = "and",
+    [TokenKindDo] = "do",
+    [TokenKindElse] = "else",
+    [TokenKindElseif] = "elseif",
+    [TokenKindEnd] = "end",
+    [TokenKindFor] = "for",
+    [TokenKindFunction] = "function",
+    [TokenKindIf] = "if",
+    [TokenKindIn] = "in",
+    [TokenKindLocal] = "local",
+    [TokenKindNot] = "not",
+    [TokenKindOr] = "or",
+    [TokenKindReturn] = "return",
+    [TokenKindThen] = "then",
+    [TokenKindWhile] = "while",
+    [TokenKindEqual] = "=",
+    [TokenKindEqualEqual] = "==",
+    [TokenKindBangEqual] = "!=",
+    [TokenKindTildeEqual] = "~=",
+    [TokenKindLessEqual] = "<=",
+    [TokenKindGreaterEqual] = ">=",
+    [TokenKindLess] = "<",
+    [TokenKindGreater] = ">",
+    [TokenKindDotDot] = "..",
+    [TokenKindPlus] = "+",
+    [TokenKindMinus] = "-",
+    [TokenKindStar] = "*",
+    [TokenKindSlash] = "/",
+    [TokenKindPercent] = "%",
+    [TokenKindHash] = "#",
+    [TokenKindComma] = ",",
+    [TokenKindLeftParenthesis] = "(",
+    [TokenKindRightParenthesis] = ")",
+    [TokenKindLeftBrace] = "{",
+    [TokenKindRightBrace] = "}",
+    [TokenKindLeftBracket] = "[",
+    [TokenKindRightBracket] = "]",
+};
+
+static bool LexerIsVectorized = true;
+
+void LexerSetVectorized(bool isVectorized)
+{
+    LexerIsVectorized = isVectorized;
+}
+
+// Lexes the next window of tokens in one pass, replacing the previous window. Stops early at the end of the file.
+static void LexerTokenize(Lexer *lexer)
+{
+    lexer->tokenCount = 0;
+    lexer->tokenI = 0;
+
+    while (lexer->tokenCount < LEXER_TOKEN_WINDOW_SIZE)
+    {
+        Token token = LexerRead(lexer);
+
+        lexer->tokens[lexer->tokenCount] = token;
+        lexer->tokenCount += 1;
+
+        if (token.kind == TokenKindEndOfFile)
+        {
+            break;
+        }
+    }
+}
+
+Lexer LexerNew(char *data, int64_t dataCount)
 {
     Lexer lexer = (Lexer){
         .data = data,
         .dataCount = dataCount,
+        .tokens = malloc(sizeof(Token) * LEXER_TOKEN_WINDOW_SIZE),
         .current = {0},
         .position = 0,
     };
 
+    assert(lexer.tokens);
+
+    LexerTokenize(&lexer);
+    lexer.current = lexer.tokens[0];
+
+    return lexer;
+}
+
+Lexer LexerNewStream(LexerReadFunction read, void *readUser)
+{
+    Lexer lexer = (Lexer){
+        .data = malloc(LEXER_CHUNK_SIZE),
+        .read = read,
+        .readUser = readUser,
+        .dataCapacity = LEXER_CHUNK_SIZE,
+    };
+
+    assert(lexer.data);
+
     lexer.current = LexerRead(&lexer);
 
     return lexer;
 }
 
-static char LexerGetChar(const Lexer *lexer, int32_t i)
+void LexerDelete(Lexer *lexer)
+{
+    // Sources that aren't streamed belong to the caller.
+    if (!lexer->tokens)
+    {
+        free(lexer->data);
+    }
+
+    free(lexer->tokens);
+
+    *lexer = (Lexer){0};
+}
+
+// Reads more of the source until the window reaches the given position. Whatever is before the last returned token
+// is dropped to make room, and the window only grows when a single token is larger than it.
+static bool LexerFill(Lexer *lexer, int64_t i)
 {
-    if (i >= lexer->dataCount)
+    if (!lexer->read)
     {
-        return '\0';
+        return false;
     }
 
-    return lexer->data[i];
+    while (i >= lexer->dataStart + lexer->dataCount)
+    {
+        int64_t keptStart = lexer->keepStart - lexer->dataStart;
+
+        if (keptStart > 0)
+        {
+            lexer->dataCount -= keptStart;
+            memmove(lexer->data, lexer->data + keptStart, (size_t)lexer->dataCount);
+            lexer->dataStart = lexer->keepStart;
+        }
+
+        if (lexer->dataCount == lexer->dataCapacity)
+        {
+            lexer->dataCapacity *= 2;
+            lexer->data = realloc(lexer->data, (size_t)lexer->dataCapacity);
+            assert(lexer->data);
+        }
+
+        int64_t readCapacity = lexer->dataCapacity - lexer->dataCount;
+
+        if (readCapacity > INT32_MAX)
+        {
+            readCapacity = INT32_MAX;
+        }
+
+        int32_t readCount = lexer->read(lexer->readUser, lexer->data + lexer->dataCount, (int32_t)readCapacity);
+
+        if (readCount <= 0)
+        {
+            lexer->read = NULL;
+            return false;
+        }
+
+        lexer->dataCount += readCount;
+    }
+
+    return true;
 }
 
-char LexerChar(const Lexer *lexer)
+static char LexerGetChar(Lexer *lexer, int64_t i)
+{
+    int64_t dataI = i - lexer->dataStart;
+
+    if (dataI >= lexer->dataCount)
+    {
+        if (!LexerFill(lexer, i))
+        {
+            return '\0';
+        }
+
+        dataI = i - lexer->dataStart;
+    }
+
+    return lexer->data[dataI];
+}
+
+// Each kind of run that the lexer skips over is checked a character at a time, and then 16 or 32 characters at a time
+// when SSE2 or AVX2 are available. The vectorized checks return a mask with a bit set for each character that ends
+// the run. Characters are compared as signed bytes, so anything outside of ASCII is negative and never in a range.
+
+static bool LexerIsWhitespaceEnd(char c)
+{
+    return c != ' ' && (c < '\t' || c > '\r');
+}
+
+static bool LexerIsIdentifierEnd(char c)
+{
+    char lower = (char)(c | 0x20);
+
+    return (c < '0' || c > '9') && (lower < 'a' || lower > 'z') && c != '_' && c != '.' && c != ':' && c != '[' &&
+           c != ']';
+}
+
+static bool LexerIsStringEnd(char c)
+{
+    return c == '"' || c == '\0';
+}
+
+static bool LexerIsCommentEnd(char c)
+{
+    return c == '\r' || c == '\n' || c == '\0';
+}
+
+static int32_t LexerCountTrailingZeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+
+    return (int32_t)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#ifdef LEXER_SSE2
+static __m128i LexerIsInRange16(__m128i chars, char low, char high)
+{
+    __m128i isAboveLow = _mm_cmpgt_epi8(chars, _mm_set1_epi8((char)(low - 1)));
+    __m128i isBelowHigh = _mm_cmplt_epi8(chars, _mm_set1_epi8((char)(high + 1)));
+
+    return _mm_and_si128(isAboveLow, isBelowHigh);
+}
+
+static __m128i LexerIsEqual16(__m128i chars, char c)
+{
+    return _mm_cmpeq_epi8(chars, _mm_set1_epi8(c));
+}
+
+static uint32_t LexerWhitespaceEnds16(__m128i chars)
+{
+    __m128i isWhitespace = _mm_or_si128(LexerIsEqual16(chars, ' '), LexerIsInRange16(chars, '\t', '\r'));
+
+    return ~(uint32_t)_mm_movemask_epi8(isWhitespace) & 0xFFFF;
+}
+
+static uint32_t LexerIdentifierEnds16(__m128i chars)
+{
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    __m128i isAlphanumeric = _mm_or_si128(LexerIsInRange16(chars, '0', '9'), LexerIsInRange16(lower, 'a', 'z'));
+    __m128i isBracket = _mm_or_si128(LexerIsEqual16(chars, '['), LexerIsEqual16(chars, ']'));
+    __m128i isSymbol = _mm_or_si128(_mm_or_si128(LexerIsEqual16(chars, '_'), LexerIsEqual16(chars, '.')),
+        _mm_or_si128(LexerIsEqual16(chars, ':'), isBracket));
+
+    return ~(uint32_t)_mm_movemask_epi8(_mm_or_si128(isAlphanumeric, isSymbol)) & 0xFFFF;
+}
+
+static uint32_t LexerStringEnds16(__m128i chars)
+{
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(LexerIsEqual16(chars, '"'), LexerIsEqual16(chars, '\0')));
+}
+
+static uint32_t LexerCommentEnds16(__m128i chars)
+{
+    __m128i isNewline = _mm_or_si128(LexerIsEqual16(chars, '\r'), LexerIsEqual16(chars, '\n'));
+
+    return (uint32_t)_mm_movemask_epi8(_mm_or_si128(isNewline, LexerIsEqual16(chars, '\0')));
+}
+
+#define LEXER_SCAN_SSE2(name)                                                                                          \
+    for (; i + 16 <= count; i += 16)                                                                                   \
+    {                                                                                                                  \
+        uint32_t ends = Lexer##name##Ends16(_mm_loadu_si128((const __m128i *)(data + i)));                             \
+                                                                                                                       \
+        if (ends)                                                                                                      \
+        {                                                                                                              \
+            return i + LexerCountTrailingZeros(ends);                                                                  \
+        }                                                                                                              \
+    }
+#else
+#define LEXER_SCAN_SSE2(name)
+#endif
+
+#ifdef LEXER_AVX2
+static __m256i LexerIsInRange32(__m256i chars, char low, char high)
+{
+    __m256i isAboveLow = _mm256_cmpgt_epi8(chars, _mm256_set1_epi8((char)(low - 1)));
+    __m256i isBelowHigh = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(high + 1)), chars);
+
+    return _mm256_and_si256(isAboveLow, isBelowHigh);
+}
+
+static __m256i LexerIsEqual32(__m256i chars, char c)
+{
+    return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(c));
+}
+
+static uint32_t LexerWhitespaceEnds32(__m256i chars)
+{
+    __m256i isWhitespace = _mm256_or_si256(LexerIsEqual32(chars, ' '), LexerIsInRange32(chars, '\t', '\r'));
+
+    return ~(uint32_t)_mm256_movemask_epi8(isWhitespace);
+}
+
+static uint32_t LexerIdentifierEnds32(__m256i chars)
+{
+    __m256i lower = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+    __m256i isAlphanumeric = _mm256_or_si256(LexerIsInRange32(chars, '0', '9'), LexerIsInRange32(lower, 'a', 'z'));
+    __m256i isBracket = _mm256_or_si256(LexerIsEqual32(chars, '['), LexerIsEqual32(chars, ']'));
+    __m256i isSymbol = _mm256_or_si256(_mm256_or_si256(LexerIsEqual32(chars, '_'), LexerIsEqual32(chars, '.')),
+        _mm256_or_si256(LexerIsEqual32(chars, ':'), isBracket));
+
+    return ~(uint32_t)_mm256_movemask_epi8(_mm256_or_si256(isAlphanumeric, isSymbol));
+}
+
+static uint32_t LexerStringEnds32(__m256i chars)
+{
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(LexerIsEqual32(chars, '"'), LexerIsEqual32(chars, '\0')));
+}
+
+static uint32_t LexerCommentEnds32(__m256i chars)
+{
+    __m256i isNewline = _mm256_or_si256(LexerIsEqual32(chars, '\r'), LexerIsEqual32(chars, '\n'));
+
+    return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(isNewline, LexerIsEqual32(chars, '\0')));
+}
+
+#define LEXER_SCAN_AVX2(name)                                                                                          \
+    for (; i + 32 <= count; i += 32)                                                                                   \
+    {                                                                                                                  \
+        uint32_t ends = Lexer##name##Ends32(_mm256_loadu_si256((const __m256i *)(data + i)));                          \
+                                                                                                                       \
+        if (ends)                                                                                                      \
+        {                                                                                                              \
+            return i + LexerCountTrailingZeros(ends);                                                                  \
+        }                                                                                                              \
+    }
+#else
+#define LEXER_SCAN_AVX2(name)
+#endif
+
+// Most runs are only a few characters long, so the first few are checked one at a time before bothering with
+// vectors. Those are only worth loading for longer identifiers, indentation, strings and comments.
+#ifndef LEXER_SCALAR_PREFIX
+#define LEXER_SCALAR_PREFIX 8
+#endif
+
+// Defines LexerScan<name>, which returns how many characters at the start of the data are part of the run.
+// The widest checks go first, and whatever is left over at the end is checked one character at a time.
+#define LEXER_DEFINE_SCAN(name)                                                                                        \
+    static int64_t LexerScan##name(const char *data, int64_t count)                                                    \
+    {                                                                                                                  \
+        int64_t scalarCount = LexerIsVectorized && count > LEXER_SCALAR_PREFIX ? LEXER_SCALAR_PREFIX : count;          \
+        int64_t i = 0;                                                                                                 \
+                                                                                                                       \
+        while (i < scalarCount && !LexerIs##name##End(data[i]))                                                        \
+        {                                                                                                              \
+            i++;                                                                                                       \
+        }                                                                                                              \
+                                                                                                                       \
+        if (i < scalarCount || i == count)                                                                             \
+        {                                                                                                              \
+            return i;                                                                                                  \
+        }                                                                                                              \
+                                                                                                                       \
+        LEXER_SCAN_AVX2(name)                                                                                          \
+        LEXER_SCAN_SSE2(name)                                                                                          \
+                                                                                                                       \
+        while (i < count && !LexerIs##name##End(data[i]))                                                              \
+        {                                                                                                              \
+            i++;                                                                                                       \
+        }                                                                                                              \
+                                                                                                                       \
+        return i;                                                                                                      \
+    }
+
+LEXER_DEFINE_SCAN(Whitespace)
+LEXER_DEFINE_SCAN(Identifier)
+LEXER_DEFINE_SCAN(String)
+LEXER_DEFINE_SCAN(Comment)
+
+typedef int64_t (*LexerScanFunction)(const char *data, int64_t count);
+
+// Moves past a run of characters directly in the data, only stopping to refill a streamed source when the run
+// reaches the end of what's been read so far.
+static void LexerSkip(Lexer *lexer, LexerScanFunction scan)
+{
+    while (true)
+    {
+        int64_t dataI = lexer->position - lexer->dataStart;
+        int64_t count = lexer->dataCount - dataI;
+
+        if (count <= 0)
+        {
+            if (!LexerFill(lexer, lexer->position))
+            {
+                return;
+            }
+
+            continue;
+        }
+
+        int64_t runCount = scan(lexer->data + dataI, count);
+        lexer->position += runCount;
+
+        if (runCount < count)
+        {
+            return;
+        }
+    }
+}
+
+char LexerChar(Lexer *lexer)
 {
     return LexerGetChar(lexer, lexer->position);
 }
 
-char LexerPeekChar(const Lexer *lexer)
+char LexerPeekChar(Lexer *lexer)
 {
     return LexerGetChar(lexer, lexer->position + 1);
 }
@@ -45,16 +491,116 @@ Token LexerPeek(const Lexer *lexer)
 Token LexerNext(Lexer *lexer)
 {
     Token token = lexer->current;
+
+    if (lexer->tokens)
+    {
+        // Once the end of the file is reached it's returned again for every following call.
+        if (lexer->tokenI + 1 < lexer->tokenCount)
+        {
+            lexer->tokenI += 1;
+        }
+        else if (token.kind != TokenKindEndOfFile)
+        {
+            LexerTokenize(lexer);
+        }
+
+        lexer->current = lexer->tokens[lexer->tokenI];
+
+        return token;
+    }
+
+    // The token's text needs to stay readable while the next one is read.
+    lexer->keepStart = token.start;
     lexer->current = LexerRead(lexer);
 
     return token;
 }
 
+// Tokens at the end of the source can reach past it, so they're cut off at what's been read.
+static Token LexerNewToken(Lexer *lexer, int64_t start, TokenKind kind)
+{
+    int64_t dataEnd = lexer->dataStart + lexer->dataCount;
+    int64_t end = lexer->position < dataEnd ? lexer->position : dataEnd;
+
+    assert(end - start <= INT32_MAX);
+
+    return (Token){
+        .start = start,
+        .length = (int32_t)(end - start),
+        .kind = kind,
+    };
+}
+
+static TokenKind LexerGetIdentifierKind(Lexer *lexer, int64_t start, int64_t length)
+{
+    if (length < 2)
+    {
+        return TokenKindIdentifier;
+    }
+
+    const char *text = lexer->data + (start - lexer->dataStart);
+    uint8_t first = (uint8_t)text[0];
+    uint8_t last = (uint8_t)text[length - 1];
+    const LexerKeyword *keyword = &LexerKeywords[LEXER_HASH_KEYWORD(first, last, length)];
+
+    if (keyword->length == length && memcmp(keyword->text, text, (size_t)length) == 0)
+    {
+        return keyword->kind;
+    }
+
+    return TokenKindIdentifier;
+}
+
+static TokenKind LexerGetSymbolKind(char c)
+{
+    switch (c)
+    {
+    case '=':
+        return TokenKindEqual;
+    case '<':
+        return TokenKindLess;
+    case '>':
+        return TokenKindGreater;
+    case '+':
+        return TokenKindPlus;
+    case '-':
+        return TokenKindMinus;
+    case '*':
+        return TokenKindStar;
+    case '/':
+        return TokenKindSlash;
+    case '%':
+        return TokenKindPercent;
+    case '#':
+        return TokenKindHash;
+    case ',':
+        return TokenKindComma;
+    case '(':
+        return TokenKindLeftParenthesis;
+    case ')':
+        return TokenKindRightParenthesis;
+    case '{':
+        return TokenKindLeftBrace;
+    case '}':
+        return TokenKindRightBrace;
+    case '[':
+        return TokenKindLeftBracket;
+    case ']':
+        return TokenKindRightBracket;
+    default:
+        return TokenKindOther;
+    }
+}
+
 Token LexerRead(Lexer *lexer)
 {
-    while (isspace(LexerChar(lexer)))
+    LexerSkip(lexer, LexerScanWhitespace);
+
+    int64_t start = lexer->position;
+
+    if (LexerChar(lexer) == '\0' && start >= lexer->dataStart + lexer->dataCount)
     {
-        lexer->position += 1;
+        return LexerNewToken(lexer, start, TokenKindEndOfFile);
     }
 
     if (isalpha(LexerChar(lexer)))
@@ -63,48 +609,26 @@ Token LexerRead(Lexer *lexer)
         // TODO: Identifiers should not contain ., :, [, ], etc. I'm just doing this right now as a quick hack. Those should
         // be blocks, ie: (. a b c d) == a.b.c.d
 
-        int32_t start = lexer->position;
+        LexerSkip(lexer, LexerScanIdentifier);
 
-        while (isalnum(LexerChar(lexer)) || LexerChar(lexer) == '_' || LexerChar(lexer) == '.' ||
-               LexerChar(lexer) == ':' || LexerChar(lexer) == '[' || LexerChar(lexer) == ']')
-        {
-            lexer->position += 1;
-        }
-
-        int32_t end = lexer->position;
-
-        return (Token){
-            .start = start,
-            .end = end,
-        };
+        return LexerNewToken(lexer, start, LexerGetIdentifierKind(lexer, start, lexer->position - start));
     }
 
     if (LexerChar(lexer) == '"')
     {
         // This is a string.
 
-        int32_t start = lexer->position;
         lexer->position += 1;
-
-        while (LexerChar(lexer) != '"' && LexerChar(lexer) != '\0')
-        {
-            lexer->position += 1;
-        }
-
+        LexerSkip(lexer, LexerScanString);
         lexer->position += 1;
-        int32_t end = lexer->position;
 
-        return (Token){
-            .start = start,
-            .end = end,
-        };
+        return LexerNewToken(lexer, start, TokenKindString);
     }
 
     if (isdigit(LexerChar(lexer)))
     {
         // This is a number.
 
-        int32_t start = lexer->position;
         bool hasDecimal = false;
 
         while (isdigit(LexerChar(lexer)) || (!hasDecimal && LexerChar(lexer) == '.'))
@@ -117,86 +641,67 @@ Token LexerRead(Lexer *lexer)
             lexer->position += 1;
         }
 
-        int32_t end = lexer->position;
-
-        return (Token){
-            .start = start,
-            .end = end,
-        };
+        return LexerNewToken(lexer, start, TokenKindNumber);
     }
 
     if (LexerChar(lexer) == '.' && LexerPeekChar(lexer) == '.')
     {
-        Token token = (Token){
-            .start = lexer->position,
-            .end = lexer->position + 2,
-        };
         lexer->position += 2;
 
-        return token;
+        return LexerNewToken(lexer, start, TokenKindDotDot);
     }
 
     if (LexerPeekChar(lexer) == '=')
     {
+        TokenKind kind = TokenKindNone;
+
         switch (LexerChar(lexer))
         {
         case '<':
+            kind = TokenKindLessEqual;
+            break;
         case '>':
+            kind = TokenKindGreaterEqual;
+            break;
         case '=':
-        case '~': {
-            Token token = (Token){
-                .start = lexer->position,
-                .end = lexer->position + 2,
-            };
+            kind = TokenKindEqualEqual;
+            break;
+        case '~':
+            kind = TokenKindTildeEqual;
+            break;
+        case '!':
+            kind = TokenKindBangEqual;
+            break;
+        }
+
+        if (kind != TokenKindNone)
+        {
             lexer->position += 2;
 
-            return token;
-        }
+            return LexerNewToken(lexer, start, kind);
         }
     }
 
     if (LexerChar(lexer) == '-' && LexerPeekChar(lexer) == '-')
     {
-        int32_t start = lexer->position;
-
-        while (LexerChar(lexer) != '\r' && LexerChar(lexer) != '\n' && LexerChar(lexer) != '\0')
-        {
-            lexer->position += 1;
-        }
-
-        int32_t end = lexer->position;
+        LexerSkip(lexer, LexerScanComment);
 
-        return (Token){
-            .start = start,
-            .end = end,
-        };
+        return LexerNewToken(lexer, start, TokenKindComment);
     }
 
-    Token token = (Token){
-        .start = lexer->position,
-        .end = lexer->position + 1,
-    };
+    TokenKind kind = LexerGetSymbolKind(LexerChar(lexer));
     lexer->position += 1;
 
-    return token;
+    return LexerNewToken(lexer, start, kind);
 }
 
-bool LexerTokenEquals(Lexer *lexer, Token token, char *string, bool isPrefix)
+const char *LexerGetTokenKindName(TokenKind kind)
 {
-    for (int32_t i = token.start; i < token.end; i++)
-    {
-        int32_t stringI = i - token.start;
-
-        if (string[stringI] == '\0')
-        {
-            return isPrefix;
-        }
-
-        if (string[stringI] != lexer->data[i])
-        {
-            return false;
-        }
-    }
+    return TokenKindNames[kind];
+}
 
-    return isPrefix || string[token.end - token.start] == '\0';
+// Only valid until the next call to LexerNext.
+char *LexerGetTokenText(const Lexer *lexer, Token token)
+{
+    return lexer->data + (token.start - lexer->dataStart);
 }
\ No newline at end of file
@@ -3,24 +3,106 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+typedef enum TokenKind
+{
+    // Never produced by the lexer, used where no token is expected.
+    TokenKindNone,
+    TokenKindEndOfFile,
+    TokenKindIdentifier,
+    TokenKindString,
+    TokenKindNumber,
+    TokenKindComment,
+    TokenKindOther,
+
+    TokenKindAnd,
+    TokenKindDo,
+    TokenKindElse,
+    TokenKindElseif,
+    TokenKindEnd,
+    TokenKindFor,
+    TokenKindFunction,
+    TokenKindIf,
+    TokenKindIn,
+    TokenKindLocal,
+    TokenKindNot,
+    TokenKindOr,
+    TokenKindReturn,
+    TokenKindThen,
+    TokenKindWhile,
+
+    TokenKindEqual,
+    TokenKindEqualEqual,
+    TokenKindBangEqual,
+    TokenKindTildeEqual,
+    TokenKindLessEqual,
+    TokenKindGreaterEqual,
+    TokenKindLess,
+    TokenKindGreater,
+    TokenKindDotDot,
+    TokenKindPlus,
+    TokenKindMinus,
+    TokenKindStar,
+    TokenKindSlash,
+    TokenKindPercent,
+    TokenKindHash,
+    TokenKindComma,
+    TokenKindLeftParenthesis,
+    TokenKindRightParenthesis,
+    TokenKindLeftBrace,
+    TokenKindRightBrace,
+    TokenKindLeftBracket,
+    TokenKindRightBracket,
+
+    TokenKindCount,
+} TokenKind;
+
+// Positions are 64 bit so that sources larger than 2 GB can be lexed.
 typedef struct Token
 {
-    int32_t start;
-    int32_t end;
+    int64_t start;
+    int32_t length;
+    TokenKind kind;
 } Token;
 
+// Copies up to count bytes of the source into the buffer, continuing from where the last read ended.
+// Returns how many bytes were read, which is only 0 at the end of the source.
+typedef int32_t (*LexerReadFunction)(void *user, char *buffer, int32_t count);
+
+// Lexes either a source that's entirely in memory, or one that's streamed in chunks from a read function.
+// Sources in memory are lexed a window of tokens at a time into an array, which LexerNext then steps through,
+// so memory for tokens stays the same however large the source is.
+// When streaming, tokens are lexed one at a time and only a window of the source is kept, which holds everything
+// from the start of the token that was last returned by LexerNext onwards. So a token's text can only be read until
+// the next call to LexerNext.
 typedef struct Lexer
 {
     char *data;
-    int32_t dataCount;
+    int64_t dataStart;
+    int64_t dataCount;
+
+    LexerReadFunction read;
+    void *readUser;
+    int64_t dataCapacity;
+    int64_t keepStart;
+
+    Token *tokens;
+    int32_t tokenCount;
+    int32_t tokenI;
+
     Token current;
-    int32_t position;
+    int64_t position;
 } Lexer;
 
-Lexer LexerNew(char *data, int32_t dataCount);
-char LexerChar(const Lexer *lexer);
-char LexerPeekChar(const Lexer *lexer);
+// Runs of whitespace, identifiers, strings and comments are scanned with SIMD instructions when they're available.
+// Turning that off falls back to checking each character, which is only useful for comparing the two.
+void LexerSetVectorized(bool isVectorized);
+Lexer LexerNew(char *data, int64_t dataCount);
+Lexer LexerNewStream(LexerReadFunction read, void *readUser);
+void LexerDelete(Lexer *lexer);
+char LexerChar(Lexer *lexer);
+char LexerPeekChar(Lexer *lexer);
 Token LexerPeek(const Lexer *lexer);
 Token LexerNext(Lexer *lexer);
 Token LexerRead(Lexer *lexer);
-bool LexerTokenEquals(Lexer *lexer, Token token, char *string, bool isPrefix);
\ No newline at end of file
+const char *LexerGetTokenKindName(TokenKind kind);
+char *LexerGetTokenText(const Lexer *lexer, Token token);
\ No newline at end of file
@@ -13,11 +13,17 @@
 #include "Camera.h"
 #include "Cursor.h"
 #include "Font.h"
+#include "FontCache.h"
 #include "Input.h"
+#include "MappedFile.h"
 #include "Math.h"
 #include "Parser.h"
+#include "Profiler.h"
+#include "RectBatch.h"
 #include "Shapes.h"
+#include "StringTable.h"
 #include "Theme.h"
+#include "Tracer.h"
 
 #include <assert.h>
 #include <stdio.h>
@@ -50,11 +56,16 @@
 
 static const float DefaultFontSize = 16;
 static const char *FontPath = "DejaVuSans.ttf";
+// Limits how often frames are drawn while something is animating, 0 means no limit.
+static const double DefaultFrameCap = 144.0;
+// While idle the window is still redrawn this often, in case something changed without an event.
+static const double IdleRedrawInterval = 1.0;
 
 typedef struct WindowData
 {
     Input *input;
     Camera *camera;
+    bool needsRedraw;
 } WindowData;
 
 static void WindowKeyCallback(GLFWwindow *window, int32_t key, int32_t scanCode, int32_t action, int32_t modifiers)
@@ -63,6 +74,7 @@ static void WindowKeyCallback(GLFWwindow *window, int32_t key, int32_t scanCode,
 
     WindowData *windowData = glfwGetWindowUserPointer(window);
     InputUpdateButton(windowData->input, key, action);
+    windowData->needsRedraw = true;
 }
 
 static void Utf32ToUtf8(List_char *destination, uint32_t codePoint)
@@ -94,6 +106,7 @@ static void WindowCharCallback(GLFWwindow *window, uint32_t codePoint)
 {
     WindowData *windowData = glfwGetWindowUserPointer(window);
     Utf32ToUtf8(&windowData->input->typedChars, codePoint);
+    windowData->needsRedraw = true;
 }
 
 static void WindowSizeCallback(GLFWwindow *window, int32_t width, int32_t height)
@@ -101,6 +114,103 @@ static void WindowSizeCallback(GLFWwindow *window, int32_t width, int32_t height
     WindowData *windowData = glfwGetWindowUserPointer(window);
     windowData->camera->width = (float)width;
     windowData->camera->height = (float)height;
+    windowData->needsRedraw = true;
+}
+
+static void WindowRefreshCallback(GLFWwindow *window)
+{
+    WindowData *windowData = glfwGetWindowUserPointer(window);
+    windowData->needsRedraw = true;
+}
+
+static int32_t ReadFileChunk(void *user, char *buffer, int32_t count)
+{
+    return (int32_t)fread(buffer, sizeof(char), count, (FILE *)user);
+}
+
+// Draws timings and counters for recent frames in the top left corner of the window.
+static void DrawProfilerOverlay(Font *font, Theme *theme)
+{
+    const float margin = 8.0f;
+    const float lineHeight = 18.0f;
+    const float width = 400.0f;
+
+    sgp_push_transform();
+    sgp_reset_transform();
+
+    int32_t lineCount = 1 + ProfilerPhaseCount + ProfilerCounterCount;
+
+    ColorSet(theme->borderColor);
+    DrawRect(margin, margin, width, lineHeight * lineCount + margin * 2, 1.0f);
+
+    ColorSet(theme->textColor);
+
+    char line[128];
+    float y = margin * 2;
+
+    FontDraw("Phase: min / avg / p99 (ms)", margin * 2, y, font);
+    y += lineHeight;
+
+    for (int32_t i = 0; i < ProfilerPhaseCount; i++)
+    {
+        ProfilerPhaseStats stats = ProfilerGetPhaseStats(i);
+        snprintf(line, sizeof(line), "%s: %.3f / %.3f / %.3f", ProfilerPhaseNames[i], stats.min * 1000.0,
+            stats.average * 1000.0, stats.p99 * 1000.0);
+
+        FontDraw(line, margin * 2, y, font);
+        y += lineHeight;
+    }
+
+    for (int32_t i = 0; i < ProfilerCounterCount; i++)
+    {
+        snprintf(line, sizeof(line), "%s: %lld", ProfilerCounterNames[i], (long long)ProfilerGetCounter(i));
+
+        FontDraw(line, margin * 2, y, font);
+        y += lineHeight;
+    }
+
+    FontFlush(font);
+
+    sgp_pop_transform();
+}
+
+// Sleeps until there's something new to draw, or until the idle redraw interval has passed.
+static void WindowWaitForRedraw(GLFWwindow *window, WindowData *windowData)
+{
+    double idleEndTime = glfwGetTime() + IdleRedrawInterval;
+
+    while (!windowData->needsRedraw && !glfwWindowShouldClose(window))
+    {
+        double remainingTime = idleEndTime - glfwGetTime();
+
+        if (remainingTime <= 0.0)
+        {
+            break;
+        }
+
+        glfwWaitEventsTimeout(remainingTime);
+    }
+}
+
+// Sleeps until the next frame is due, handling events in the mean time.
+static void WindowWaitForFrame(double frameTime, double frameCap)
+{
+    if (frameCap <= 0.0)
+    {
+        glfwPollEvents();
+        return;
+    }
+
+    double nextFrameTime = frameTime + 1.0 / frameCap;
+    double remainingTime = nextFrameTime - glfwGetTime();
+
+    glfwPollEvents();
+
+    while (remainingTime > 0.0)
+    {
+        glfwWaitEventsTimeout(remainingTime);
+        remainingTime = nextFrameTime - glfwGetTime();
+    }
 }
 
 int main(int argumentCount, char **arguments)
@@ -122,12 +232,14 @@ int main(int argumentCount, char **arguments)
     WindowData windowData = (WindowData){
         .input = &input,
         .camera = &camera,
+        .needsRedraw = true,
     };
 
     glfwSetWindowUserPointer(window, &windowData);
     glfwSetKeyCallback(window, WindowKeyCallback);
     glfwSetCharCallback(window, WindowCharCallback);
     glfwSetWindowSizeCallback(window, WindowSizeCallback);
+    glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
 
     {
         int32_t width, height;
@@ -145,34 +257,60 @@ int main(int argumentCount, char **arguments)
     sgp_setup(&sokolGpDescriptor);
     assert(sgp_is_valid());
 
+    RectBatch *rectBatch = RectBatchNew(false);
+    RectBatch *blockBatch = RectBatchNew(true);
+
     char *path = "save.lua";
+    double frameCap = DefaultFrameCap;
+    bool isStreamed = false;
 
-    if (argumentCount >= 2)
+    for (int32_t i = 1; i < argumentCount; i++)
     {
-        path = arguments[1];
+        if (strcmp(arguments[i], "--frame-cap") == 0 && i + 1 < argumentCount)
+        {
+            frameCap = atof(arguments[i + 1]);
+            i += 1;
+        }
+        else if (strcmp(arguments[i], "--trace") == 0 && i + 1 < argumentCount)
+        {
+            TracerStart(arguments[i + 1]);
+            i += 1;
+        }
+        else if (strcmp(arguments[i], "--stream") == 0)
+        {
+            isStreamed = true;
+        }
+        else
+        {
+            path = arguments[i];
+        }
     }
 
-    char *data = NULL;
-    int32_t dataCount = 0;
+    // Files are kept mapped until they're saved over, so that identifiers can point into them rather than being copied.
+    // Streamed files are read in chunks while they're parsed instead, which keeps memory bounded for very large files.
+    MappedFile source = {0};
+    FILE *streamedFile = NULL;
+
+    if (isStreamed)
     {
-        FILE *file = fopen(path, "rb");
-        if (!file)
+        streamedFile = fopen(path, "rb");
+        if (!streamedFile)
         {
             printf("Couldn't open file \"%s\"", path);
             exit(EXIT_FAILURE);
         }
-
-        fseek(file, 0, SEEK_END);
-        dataCount = ftell(file);
-        fseek(file, 0, SEEK_SET);
-
-        data = malloc(dataCount);
-
-        fread(data, sizeof(char), dataCount, file);
-        fclose(file);
+    }
+    else
+    {
+        TracerBegin("MapFile");
+        source = MappedFileNew(path);
+        TracerEnd("MapFile");
     }
 
-    Font *font = FontNew(FontPath, DefaultFontSize);
+    FontCache fontCache = FontCacheNew(FontPath, DefaultFontSize);
+    // Layout is measured with the base font, while drawing uses the font matching the current zoom.
+    Font *layoutFont = fontCache.baseFont;
+    Font *font = FontCacheGet(&fontCache, DefaultFontSize);
     Theme theme = (Theme){
         .backgroundColor = ColorNew255(51, 51, 51),
         .borderColor = ColorNew255(0, 0, 0),
@@ -184,19 +322,31 @@ int main(int argumentCount, char **arguments)
     };
 
     BlockKindsInit();
-    BlockKindsUpdateTextSize(font);
-
-    Parser parser = ParserNew(LexerNew(data, dataCount), font);
+    StringTableInit();
+    StringTableSetSource(source.data, source.dataCount);
+    BlockKindsUpdateTextSize(layoutFont);
+
+    BlockArena arena = BlockArenaNew();
+    Lexer lexer =
+        isStreamed ? LexerNewStream(ReadFileChunk, streamedFile) : LexerNew(source.data, source.dataCount);
+    Parser parser = ParserNew(lexer, &arena);
     Block *rootBlock = ParserParseStatement(&parser, NULL, 0);
+
+    if (streamedFile)
+    {
+        fclose(streamedFile);
+    }
     Cursor cursor = CursorNew(rootBlock);
     Saver saver = SaverNew();
 
     printf("Block count: %llu\n", BlockCountAll(rootBlock));
     printf("Block size individual: %zd\n", sizeof(Block));
     printf("Block kind size: %zd\n", sizeof(BlockKindId));
+    printf("Unique identifier count: %d\n", StringTableGetCount());
 
     double lastFrameTime = glfwGetTime();
     bool isWindowHidden = true;
+    bool isProfilerVisible = false;
 
     while (!glfwWindowShouldClose(window))
     {
@@ -205,8 +355,6 @@ int main(int argumentCount, char **arguments)
         float deltaTime = (float)(frameTime - lastFrameTime);
         lastFrameTime = frameTime;
 
-        // printf("%f\n", 1.0f / deltaTime);
-
         bool didCameraZoom = false;
         bool didAbsorbInput = false;
 
@@ -226,8 +374,7 @@ int main(int argumentCount, char **arguments)
         {
             didAbsorbInput = true;
 
-            FontDelete(font);
-            font = FontNew(FontPath, DefaultFontSize * camera.zoom);
+            font = FontCacheGet(&fontCache, DefaultFontSize * camera.zoom);
         }
 
         bool isControlHeld =
@@ -239,6 +386,12 @@ int main(int argumentCount, char **arguments)
             SaverSave(&saver, rootBlock);
 
             {
+                TracerBegin("WriteFile");
+
+                // The mapping can't outlive the file being overwritten.
+                StringTableReleaseSource();
+                MappedFileDelete(&source);
+
                 FILE *file = fopen(path, "w");
                 if (!file)
                 {
@@ -248,19 +401,40 @@ int main(int argumentCount, char **arguments)
 
                 fwrite(saver.writer.text.data, sizeof(char), saver.writer.text.count, file);
                 fclose(file);
+
+                TracerEnd("WriteFile");
             }
 
             didAbsorbInput = true;
         }
 
+        if (InputIsButtonPressed(&input, GLFW_KEY_F3))
+        {
+            isProfilerVisible = !isProfilerVisible;
+            didAbsorbInput = true;
+        }
+
         if (didAbsorbInput)
         {
             InputUpdate(&input);
         }
 
-        CursorUpdate(&cursor, &input, font);
-        BlockUpdateTree(rootBlock, 0, 0);
+        ProfilerBeginPhase(ProfilerPhaseCursorUpdate);
+        CursorUpdate(&cursor, &input);
+        ProfilerEndPhase(ProfilerPhaseCursorUpdate);
+
+        ProfilerBeginPhase(ProfilerPhaseBlockUpdateTree);
+        BlockUpdateTree(rootBlock);
+        ProfilerEndPhase(ProfilerPhaseBlockUpdateTree);
+
+        ProfilerBeginPhase(ProfilerPhaseBlockUpdateMesh);
+        BlockUpdateMesh(rootBlock, blockBatch, &theme);
+        ProfilerEndPhase(ProfilerPhaseBlockUpdateMesh);
+
+        ProfilerBeginPhase(ProfilerPhaseCameraUpdate);
         CameraUpdate(&camera, &cursor, rootBlock, deltaTime);
+        ProfilerEndPhase(ProfilerPhaseCameraUpdate);
+
         InputUpdate(&input);
 
         // Draw:
@@ -269,27 +443,67 @@ int main(int argumentCount, char **arguments)
 
         sgp_translate(MathFloatFloor(-camera.x * camera.zoom), MathFloatFloor(-camera.y * camera.zoom));
 
-        ColorSet(theme.backgroundColor);
-        sgp_clear();
+        int32_t rootBlockX, rootBlockY;
+        BlockGetGlobalPosition(rootBlock, &rootBlockX, &rootBlockY);
+        int32_t rootBlockWidth, rootBlockHeight;
+        BlockGetSize(rootBlock, &rootBlockWidth, &rootBlockHeight);
+
+        // The border is kept at least a pixel wide at any zoom level.
+        float borderWidth = MathFloatCeil(BorderWidth * camera.zoom) / camera.zoom;
+        RectBatchPush(rectBatch, (float)rootBlockX - BlockPaddingX - borderWidth,
+            (float)rootBlockY - BlockPaddingY - borderWidth, (float)rootBlockWidth + borderWidth * 2,
+            (float)rootBlockHeight + borderWidth * 2, theme.borderColor);
 
-        ColorSet(theme.borderColor);
-        DrawRectBordered((float)rootBlock->x - BlockPaddingX, (float)rootBlock->y - BlockPaddingY,
-            (float)rootBlock->width, (float)rootBlock->height, camera.zoom, BorderWidth);
+        ProfilerBeginPhase(ProfilerPhaseBlockDraw);
         BlockDraw(rootBlock, cursor.block, 0, &camera, font, &theme, 0, 0);
+        ProfilerEndPhase(ProfilerPhaseBlockDraw);
+
+        ProfilerBeginPhase(ProfilerPhaseCursorDraw);
         CursorDraw(&cursor, &camera, font, &theme, deltaTime);
+        ProfilerEndPhase(ProfilerPhaseCursorDraw);
+
+        if (isProfilerVisible)
+        {
+            DrawProfilerOverlay(layoutFont, &theme);
+        }
 
         // The font may require updates after drawing.
+        ProfilerBeginPhase(ProfilerPhaseFontUpdate);
         FontUpdate(font);
+        FontUpdate(layoutFont);
+        ProfilerEndPhase(ProfilerPhaseFontUpdate);
 
-        sg_pass_action passAction = {0};
+        ProfilerBeginPhase(ProfilerPhaseFlush);
+        sg_pass_action passAction = {
+            .colors[0] =
+                {
+                    .load_action = SG_LOADACTION_CLEAR,
+                    .clear_value = {theme.backgroundColor.r, theme.backgroundColor.g, theme.backgroundColor.b, 1.0f},
+                },
+        };
         sg_begin_default_pass(&passAction, (int32_t)camera.width, (int32_t)camera.height);
+        // The border and block backgrounds are drawn in instanced draw calls, below everything queued with sokol_gp.
+        float batchX = MathFloatFloor(-camera.x * camera.zoom);
+        float batchY = MathFloatFloor(-camera.y * camera.zoom);
+        RectBatchDraw(rectBatch, batchX, batchY, camera.zoom, camera.width, camera.height);
+        RectBatchDraw(blockBatch, batchX, batchY, camera.zoom, camera.width, camera.height);
         sgp_flush();
         sgp_end();
         sg_end_pass();
         sg_commit();
+        ProfilerEndPhase(ProfilerPhaseFlush);
+
+        FontEndFrame(font);
+
+        if (layoutFont != font)
+        {
+            FontEndFrame(layoutFont);
+        }
+
+        ProfilerEndFrame();
 
         glfwSwapBuffers(window);
-        glfwPollEvents();
+        windowData.needsRedraw = false;
 
         if (isWindowHidden)
         {
@@ -297,19 +511,38 @@ int main(int argumentCount, char **arguments)
 
             isWindowHidden = false;
         }
+
+        if (cursor.isAnimating || camera.isMoving)
+        {
+            WindowWaitForFrame(frameTime, frameCap);
+        }
+        else
+        {
+            glfwPollEvents();
+            WindowWaitForRedraw(window, &windowData);
+
+            // Time spent waiting shouldn't count towards the next frame's animations.
+            lastFrameTime = glfwGetTime();
+        }
     }
 
     SaverDelete(&saver);
     CursorDelete(&cursor);
-    BlockDelete(rootBlock);
-    FontDelete(font);
+    // Frees the whole tree at once, including blocks still referenced by the undo history.
+    BlockArenaDelete(&arena);
+    FontCacheDelete(&fontCache);
     ParserDelete(&parser);
-    free(data);
+    MappedFileDelete(&source);
 
+    StringTableDeinit();
     BlockKindsDeinit();
 
+    TracerStop();
+
     InputDelete(&input);
 
+    RectBatchDelete(blockBatch);
+    RectBatchDelete(rectBatch);
     sgp_shutdown();
     sg_shutdown();
     glfwTerminate();
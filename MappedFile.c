@@ -0,0 +1,134 @@
+#ifndef _WIN32
+// Exposes the POSIX mapping functions, even when compiling as strict C11.
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "MappedFile.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static void MappedFileFail(const char *path)
+{
+    printf("Couldn't open file \"%s\"", path);
+    exit(EXIT_FAILURE);
+}
+
+// Empty files can't be mapped, so they're left without any data.
+#ifdef _WIN32
+MappedFile MappedFileNew(const char *path)
+{
+    HANDLE fileHandle =
+        CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        MappedFileFail(path);
+    }
+
+    LARGE_INTEGER fileSize;
+
+    // Files larger than the address space can't be mapped in one view.
+    if (!GetFileSizeEx(fileHandle, &fileSize) || (uint64_t)fileSize.QuadPart > SIZE_MAX)
+    {
+        MappedFileFail(path);
+    }
+
+    MappedFile file = (MappedFile){
+        .dataCount = fileSize.QuadPart,
+    };
+
+    if (file.dataCount > 0)
+    {
+        // The view keeps the mapping and file open, so their handles aren't needed after it's created.
+        HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+        if (mappingHandle)
+        {
+            file.data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mappingHandle);
+        }
+
+        if (!file.data)
+        {
+            MappedFileFail(path);
+        }
+    }
+
+    CloseHandle(fileHandle);
+
+    return file;
+}
+
+void MappedFileDelete(MappedFile *file)
+{
+    if (file->data)
+    {
+        UnmapViewOfFile(file->data);
+    }
+
+    *file = (MappedFile){0};
+}
+#else
+MappedFile MappedFileNew(const char *path)
+{
+    int fileDescriptor = open(path, O_RDONLY);
+
+    if (fileDescriptor < 0)
+    {
+        MappedFileFail(path);
+    }
+
+    struct stat fileStat;
+
+    // Files larger than the address space can't be mapped in one view.
+    if (fstat(fileDescriptor, &fileStat) != 0 || (uint64_t)fileStat.st_size > SIZE_MAX)
+    {
+        MappedFileFail(path);
+    }
+
+    MappedFile file = (MappedFile){
+        .dataCount = fileStat.st_size,
+    };
+
+    if (file.dataCount > 0)
+    {
+        void *data = mmap(NULL, (size_t)file.dataCount, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+        if (data == MAP_FAILED)
+        {
+            MappedFileFail(path);
+        }
+
+        // The file is parsed from start to end, so the OS can read ahead.
+        posix_madvise(data, (size_t)file.dataCount, POSIX_MADV_SEQUENTIAL);
+        file.data = (char *)data;
+    }
+
+    // The mapping stays valid after the file is closed.
+    close(fileDescriptor);
+
+    return file;
+}
+
+void MappedFileDelete(MappedFile *file)
+{
+    if (file->data)
+    {
+        munmap(file->data, (size_t)file->dataCount);
+    }
+
+    *file = (MappedFile){0};
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <inttypes.h>
+
+// A read only view of a whole file. The OS pages it in as it's read, rather than it being copied up front,
+// and can drop those pages again under memory pressure since they're backed by the file.
+typedef struct MappedFile
+{
+    char *data;
+    int64_t dataCount;
+} MappedFile;
+
+MappedFile MappedFileNew(const char *path);
+void MappedFileDelete(MappedFile *file);
\ No newline at end of file
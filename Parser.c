@@ -1,36 +1,41 @@
 #include "Parser.h"
+#include "Tracer.h"
 
+#include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
-Parser ParserNew(Lexer lexer, Font *font)
+Parser ParserNew(Lexer lexer, BlockArena *arena)
 {
     return (Parser){
         .lexer = lexer,
-        .font = font,
+        .arena = arena,
         .textBuffer = ListNew_char(16),
     };
 }
 
 void ParserDelete(Parser *parser)
 {
+    LexerDelete(&parser->lexer);
     ListDelete_char(&parser->textBuffer);
 }
 
-void ParserMatch(Parser *parser, char *string)
+void ParserMatch(Parser *parser, TokenKind kind)
 {
     Token next = LexerNext(&parser->lexer);
 
-    if (!LexerTokenEquals(&parser->lexer, next, string, false))
+    if (next.kind != kind)
     {
-        fprintf(stderr, "Expected \"%s\" but got: ", string);
+        fprintf(stderr, "Expected \"%s\" but got: ", LexerGetTokenKindName(kind));
 
-        for (int32_t i = 0; i < next.end - next.start; i++)
+        char *text = LexerGetTokenText(&parser->lexer, next);
+
+        for (int32_t i = 0; i < next.length; i++)
         {
-            fprintf(stderr, "%c", parser->lexer.data[next.start + i]);
+            fprintf(stderr, "%c", text[i]);
         }
 
         fprintf(stderr, "\n");
@@ -40,19 +45,19 @@ void ParserMatch(Parser *parser, char *string)
     }
 }
 
-bool ParserHas(Parser *parser, char *string)
+bool ParserHas(Parser *parser, TokenKind kind)
 {
-    return LexerTokenEquals(&parser->lexer, parser->lexer.current, string, false);
+    return LexerPeek(&parser->lexer).kind == kind;
 }
 
 void ParserList(Parser *parser, Block *parent, Block *(*ParserFunction)(Parser *parser, Block *parent, int32_t childI),
-    int32_t startI, char *end, char *separator)
+    int32_t startI, TokenKind end, TokenKind separator)
 {
     int32_t i = startI;
 
     while (!ParserHas(parser, end))
     {
-        if (separator && i > startI)
+        if (separator != TokenKindNone && i > startI)
         {
             ParserMatch(parser, separator);
         }
@@ -68,32 +73,32 @@ void ParserList(Parser *parser, Block *parent, Block *(*ParserFunction)(Parser *
 
 Block *ParserParseDo(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "do");
+    ParserMatch(parser, TokenKindDo);
 
-    Block *doBlock = BlockNew(BlockKindIdDo, parent, childI);
+    Block *doBlock = BlockNew(parser->arena, BlockKindIdDo, parent, childI);
 
     int32_t i = 0;
-    while (!ParserHas(parser, "end"))
+    while (!ParserHas(parser, TokenKindEnd))
     {
         Block *statement = ParserParseStatement(parser, doBlock, i);
         BlockReplaceChild(doBlock, statement, i, true);
         i += 1;
     }
 
-    ParserMatch(parser, "end");
+    ParserMatch(parser, TokenKindEnd);
 
     return doBlock;
 }
 
 Block *ParserParseCase(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *caseBlock = BlockNew(BlockKindIdCase, parent, childI);
+    Block *caseBlock = BlockNew(parser->arena, BlockKindIdCase, parent, childI);
     Block *condition = ParserParseExpression(parser, caseBlock, 0);
     BlockReplaceChild(caseBlock, condition, 0, true);
-    ParserMatch(parser, "then");
+    ParserMatch(parser, TokenKindThen);
 
     int32_t i = 1;
-    while (!ParserHas(parser, "elseif") && !ParserHas(parser, "else") && !ParserHas(parser, "end"))
+    while (!ParserHas(parser, TokenKindElseif) && !ParserHas(parser, TokenKindElse) && !ParserHas(parser, TokenKindEnd))
     {
         BlockReplaceChild(caseBlock, ParserParseStatement(parser, caseBlock, i), i, true);
         i += 1;
@@ -104,18 +109,18 @@ Block *ParserParseCase(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseIfCases(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *ifCases = BlockNew(BlockKindIdIfCases, parent, childI);
+    Block *ifCases = BlockNew(parser->arena, BlockKindIdIfCases, parent, childI);
 
     int32_t i = 0;
-    while (!ParserHas(parser, "else") && !ParserHas(parser, "end"))
+    while (!ParserHas(parser, TokenKindElse) && !ParserHas(parser, TokenKindEnd))
     {
         if (i == 0)
         {
-            ParserMatch(parser, "if");
+            ParserMatch(parser, TokenKindIf);
         }
         else
         {
-            ParserMatch(parser, "elseif");
+            ParserMatch(parser, TokenKindElseif);
         }
 
         BlockReplaceChild(ifCases, ParserParseCase(parser, ifCases, i), i, true);
@@ -127,28 +132,28 @@ Block *ParserParseIfCases(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseElseCase(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "else");
+    ParserMatch(parser, TokenKindElse);
 
-    Block *elseCase = BlockNew(BlockKindIdElseCase, parent, childI);
+    Block *elseCase = BlockNew(parser->arena, BlockKindIdElseCase, parent, childI);
 
-    ParserList(parser, elseCase, ParserParseStatement, 0, "end", NULL);
+    ParserList(parser, elseCase, ParserParseStatement, 0, TokenKindEnd, TokenKindNone);
 
     return elseCase;
 }
 
 Block *ParserParseIf(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *ifBlock = BlockNew(BlockKindIdIf, parent, childI);
+    Block *ifBlock = BlockNew(parser->arena, BlockKindIdIf, parent, childI);
 
     BlockReplaceChild(ifBlock, ParserParseIfCases(parser, ifBlock, 0), 0, true);
 
-    if (ParserHas(parser, "else"))
+    if (ParserHas(parser, TokenKindElse))
     {
         BlockReplaceChild(ifBlock, ParserParseElseCase(parser, ifBlock, 0), 1, true);
     }
     else
     {
-        ParserMatch(parser, "end");
+        ParserMatch(parser, TokenKindEnd);
     }
 
     return ifBlock;
@@ -156,44 +161,44 @@ Block *ParserParseIf(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseStatementList(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *statementList = BlockNew(BlockKindIdStatementList, parent, childI);
+    Block *statementList = BlockNew(parser->arena, BlockKindIdStatementList, parent, childI);
 
-    ParserList(parser, statementList, ParserParseStatement, 0, "end", NULL);
+    ParserList(parser, statementList, ParserParseStatement, 0, TokenKindEnd, TokenKindNone);
 
     return statementList;
 }
 
 Block *ParserParseForLoop(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "for");
+    ParserMatch(parser, TokenKindFor);
 
     Block *forLoop = NULL;
     Block *iterator = ParserParseIdentifier(parser, parent, childI);
 
-    if (ParserHas(parser, "="))
+    if (ParserHas(parser, TokenKindEqual))
     {
-        ParserMatch(parser, "=");
+        ParserMatch(parser, TokenKindEqual);
 
-        forLoop = BlockNew(BlockKindIdForLoop, parent, childI);
+        forLoop = BlockNew(parser->arena, BlockKindIdForLoop, parent, childI);
 
-        Block *forLoopCondition = BlockNew(BlockKindIdForLoopCondition, forLoop, 0);
+        Block *forLoopCondition = BlockNew(parser->arena, BlockKindIdForLoopCondition, forLoop, 0);
         BlockReplaceChild(forLoop, forLoopCondition, 0, true);
         BlockReplaceChild(forLoopCondition, iterator, 0, true);
 
-        Block *forLoopBounds = BlockNew(BlockKindIdForLoopBounds, forLoopCondition, 1);
+        Block *forLoopBounds = BlockNew(parser->arena, BlockKindIdForLoopBounds, forLoopCondition, 1);
         BlockReplaceChild(forLoopCondition, forLoopBounds, 1, true);
 
         Block *lowBound = ParserParseExpression(parser, forLoopCondition, 0);
         BlockReplaceChild(forLoopBounds, lowBound, 0, true);
 
-        ParserMatch(parser, ",");
+        ParserMatch(parser, TokenKindComma);
 
         Block *highBound = ParserParseExpression(parser, forLoopCondition, 1);
         BlockReplaceChild(forLoopBounds, highBound, 1, true);
 
-        if (ParserHas(parser, ","))
+        if (ParserHas(parser, TokenKindComma))
         {
-            ParserMatch(parser, ",");
+            ParserMatch(parser, TokenKindComma);
 
             Block *step = ParserParseExpression(parser, forLoopCondition, 2);
             BlockReplaceChild(forLoopBounds, step, 2, true);
@@ -201,11 +206,11 @@ Block *ParserParseForLoop(Parser *parser, Block *parent, int32_t childI)
     }
     else
     {
-        ParserMatch(parser, "in");
+        ParserMatch(parser, TokenKindIn);
 
-        forLoop = BlockNew(BlockKindIdForInLoop, parent, childI);
+        forLoop = BlockNew(parser->arena, BlockKindIdForInLoop, parent, childI);
 
-        Block *forLoopCondition = BlockNew(BlockKindIdForInLoopCondition, forLoop, 0);
+        Block *forLoopCondition = BlockNew(parser->arena, BlockKindIdForInLoopCondition, forLoop, 0);
         BlockReplaceChild(forLoop, forLoopCondition, 0, true);
         BlockReplaceChild(forLoopCondition, iterator, 0, true);
 
@@ -213,7 +218,7 @@ Block *ParserParseForLoop(Parser *parser, Block *parent, int32_t childI)
         BlockReplaceChild(forLoopCondition, iteratorFunction, 1, true);
     }
 
-    ParserMatch(parser, "do");
+    ParserMatch(parser, TokenKindDo);
 
     Block *statementList = ParserParseStatementList(parser, forLoop, 1);
     BlockReplaceChild(forLoop, statementList, 1, true);
@@ -223,13 +228,13 @@ Block *ParserParseForLoop(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseWhileLoop(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "while");
+    ParserMatch(parser, TokenKindWhile);
 
-    Block *whileLoop = BlockNew(BlockKindIdWhileLoop, parent, childI);
+    Block *whileLoop = BlockNew(parser->arena, BlockKindIdWhileLoop, parent, childI);
 
     BlockReplaceChild(whileLoop, ParserParseExpression(parser, whileLoop, 0), 0, true);
 
-    ParserMatch(parser, "do");
+    ParserMatch(parser, TokenKindDo);
 
     BlockReplaceChild(whileLoop, ParserParseStatementList(parser, whileLoop, 1), 1, true);
 
@@ -238,17 +243,17 @@ Block *ParserParseWhileLoop(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseReturn(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "return");
+    ParserMatch(parser, TokenKindReturn);
 
-    Block *returnBlock = BlockNew(BlockKindIdReturn, parent, childI);
+    Block *returnBlock = BlockNew(parser->arena, BlockKindIdReturn, parent, childI);
 
-    if (!ParserHas(parser, "end"))
+    if (!ParserHas(parser, TokenKindEnd))
     {
         BlockReplaceChild(returnBlock, ParserParseExpression(parser, returnBlock, 0), 0, true);
     }
 
     int32_t i = 1;
-    while (ParserHas(parser, ","))
+    while (ParserHas(parser, TokenKindComma))
     {
         LexerNext(&parser->lexer);
         BlockReplaceChild(returnBlock, ParserParseExpression(parser, returnBlock, i), i, true);
@@ -261,12 +266,12 @@ Block *ParserParseReturn(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseLocal(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "local");
+    ParserMatch(parser, TokenKindLocal);
 
-    Block *localBlock = BlockNew(BlockKindIdLocal, parent, childI);
+    Block *localBlock = BlockNew(parser->arena, BlockKindIdLocal, parent, childI);
     Block *child = NULL;
 
-    if (ParserHas(parser, "function"))
+    if (ParserHas(parser, TokenKindFunction))
     {
         child = ParserParseFunction(parser, localBlock, 0);
     }
@@ -282,10 +287,10 @@ Block *ParserParseLocal(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseAssign(Parser *parser, Block  *parent, int32_t childI)
 {
-    Block *assign = BlockNew(BlockKindIdAssign, parent, childI);
+    Block *assign = BlockNew(parser->arena, BlockKindIdAssign, parent, childI);
 
     BlockReplaceChild(assign, ParserParseMultiExpression(parser, parent, childI), 0, true);
-    ParserMatch(parser, "=");
+    ParserMatch(parser, TokenKindEqual);
     BlockReplaceChild(assign, ParserParseMultiExpression(parser, assign, 1), 1, true);
 
     return assign;
@@ -293,40 +298,41 @@ Block *ParserParseAssign(Parser *parser, Block  *parent, int32_t childI)
 
 Block *ParserParseComment(Parser *parser, Block  *parent, int32_t childI)
 {
-    Block *comment = BlockNew(BlockKindIdComment, parent, childI);
+    Block *comment = BlockNew(parser->arena, BlockKindIdComment, parent, childI);
 
     Token token = LexerNext(&parser->lexer);
+    char *tokenText = LexerGetTokenText(&parser->lexer, token);
+    int32_t tokenLength = token.length;
 
-    int32_t startI = token.start + 2;
-    while (isspace(parser->lexer.data[startI]))
+    int32_t startI = 2;
+    while (startI < tokenLength && isspace(tokenText[startI]))
     {
         startI += 1;
     }
 
-    int32_t textLength = token.end - startI;
-
-    BlockReplaceChild(comment, BlockNewIdentifier(parser->lexer.data + startI, textLength, parser->font, comment, 0), 0, true);
+    Block *text = BlockNewIdentifier(parser->arena, tokenText + startI, tokenLength - startI, comment, 0);
+    BlockReplaceChild(comment, text, 0, true);
 
     return comment;
 }
 
 Block *ParserParseFunctionHeader(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *functionHeader = BlockNew(BlockKindIdFunctionHeader, parent, childI);
+    Block *functionHeader = BlockNew(parser->arena, BlockKindIdFunctionHeader, parent, childI);
 
-    ParserMatch(parser, "function");
+    ParserMatch(parser, TokenKindFunction);
 
     BlockReplaceChild(functionHeader, ParserParseIdentifier(parser, parent, 0), 0, true);
 
-    ParserMatch(parser, "(");
-    ParserList(parser, functionHeader, ParserParseIdentifier, 1, ")", ",");
+    ParserMatch(parser, TokenKindLeftParenthesis);
+    ParserList(parser, functionHeader, ParserParseIdentifier, 1, TokenKindRightParenthesis, TokenKindComma);
 
     return functionHeader;
 }
 
 Block *ParserParseFunction(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *functionBlock = BlockNew(BlockKindIdFunction, parent, childI);
+    Block *functionBlock = BlockNew(parser->arena, BlockKindIdFunction, parent, childI);
 
     BlockReplaceChild(functionBlock, ParserParseFunctionHeader(parser, functionBlock, 0), 0, true);
     BlockReplaceChild(functionBlock, ParserParseStatementList(parser, functionBlock, 1), 1, true);
@@ -336,19 +342,19 @@ Block *ParserParseFunction(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseLambdaFunctionHeader(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *lambdaFunctionHeader = BlockNew(BlockKindIdLambdaFunctionHeader, parent, childI);
+    Block *lambdaFunctionHeader = BlockNew(parser->arena, BlockKindIdLambdaFunctionHeader, parent, childI);
 
-    ParserMatch(parser, "function");
+    ParserMatch(parser, TokenKindFunction);
 
-    ParserMatch(parser, "(");
-    ParserList(parser, lambdaFunctionHeader, ParserParseIdentifier, 1, ")", ",");
+    ParserMatch(parser, TokenKindLeftParenthesis);
+    ParserList(parser, lambdaFunctionHeader, ParserParseIdentifier, 1, TokenKindRightParenthesis, TokenKindComma);
 
     return lambdaFunctionHeader;
 }
 
 Block *ParserParseLambdaFunction(Parser *parser, Block *parent, int32_t childI)
 {
-    Block *lambdaFunction = BlockNew(BlockKindIdLambdaFunction, parent, childI);
+    Block *lambdaFunction = BlockNew(parser->arena, BlockKindIdLambdaFunction, parent, childI);
 
     BlockReplaceChild(lambdaFunction, ParserParseLambdaFunctionHeader(parser, lambdaFunction, 0), 0, true);
     BlockReplaceChild(lambdaFunction, ParserParseStatementList(parser, lambdaFunction, 1), 1, true);
@@ -356,138 +362,88 @@ Block *ParserParseLambdaFunction(Parser *parser, Block *parent, int32_t childI)
     return lambdaFunction;
 }
 
-static Block *ParserParseExpressionList(Parser *parser, Block *parent, int32_t childI, BlockKindId kindId, char *separator,
-    Block *(*innerParseFunction)(Parser *parser, Block *parent, int32_t childI))
-{
-    Block *left = innerParseFunction(parser, parent, childI);
-
-    if (!ParserHas(parser, separator))
-    {
-        return left;
-    }
-
-    Block *block = BlockNew(kindId, parent, childI);
-    BlockReplaceChild(block, left, 0, true);
+// Binary operators, from the loosest to the tightest binding. Operators that group into lists collect every operand
+// joined by them into one block, ie: a + b + c is (+ a b c). Pairs only ever have two operands.
+typedef struct ParserBinaryOperator
+{
+    BlockKindId kindId;
+    int32_t precedence;
+    bool isList;
+} ParserBinaryOperator;
+
+static const int32_t ParserMaxPrecedence = 14;
+
+// Tokens that aren't binary operators have a precedence of 0, which is looser than any operator.
+static const ParserBinaryOperator ParserBinaryOperators[TokenKindCount] = {
+    [TokenKindOr] = {BlockKindIdOr, 1, true},
+    [TokenKindAnd] = {BlockKindIdAnd, 2, true},
+    [TokenKindEqualEqual] = {BlockKindIdEqual, 3, true},
+    [TokenKindBangEqual] = {BlockKindIdNotEqual, 4, true},
+    [TokenKindLess] = {BlockKindIdLess, 5, false},
+    [TokenKindGreater] = {BlockKindIdGreater, 6, false},
+    [TokenKindLessEqual] = {BlockKindIdLessEqual, 7, false},
+    [TokenKindGreaterEqual] = {BlockKindIdGreaterEqual, 8, false},
+    [TokenKindPlus] = {BlockKindIdAdd, 9, true},
+    [TokenKindMinus] = {BlockKindIdSubtract, 10, true},
+    [TokenKindStar] = {BlockKindIdMultiply, 11, true},
+    [TokenKindSlash] = {BlockKindIdDivide, 12, true},
+    [TokenKindPercent] = {BlockKindIdModulo, 13, true},
+    [TokenKindDotDot] = {BlockKindIdConcatenate, 14, true},
+};
+
+// Parses operators that bind at least as tightly as the minimum precedence, climbing to tighter operators for each
+// operand. Each precedence is only grouped once, so after an operator's block is built only looser operators can
+// continue the expression, ie: a < b < c stops after a < b, and a * b + c * d is (+ (* a b) (* c d)).
+static Block *ParserParseBinaryExpression(Parser *parser, Block *parent, int32_t childI, int32_t minPrecedence)
+{
+    Block *left = ParserParseUnaryPrefix(parser, parent, childI);
+    int32_t maxPrecedence = ParserMaxPrecedence;
+
+    while (true)
+    {
+        TokenKind operatorKind = LexerPeek(&parser->lexer).kind;
+        const ParserBinaryOperator *binaryOperator = &ParserBinaryOperators[operatorKind];
+
+        if (binaryOperator->precedence < minPrecedence || binaryOperator->precedence > maxPrecedence)
+        {
+            return left;
+        }
 
-    int32_t i = 1;
-    while (ParserHas(parser, separator))
-    {
-        LexerNext(&parser->lexer);
+        Block *block = BlockNew(parser->arena, binaryOperator->kindId, parent, childI);
+        BlockReplaceChild(block, left, 0, true);
 
-        Block *expression = innerParseFunction(parser, block, i);
-        BlockReplaceChild(block, expression, i, true);
-        i += 1;
-    }
-
-    return block;
-}
+        int32_t i = 1;
+        do
+        {
+            LexerNext(&parser->lexer);
 
-static Block *ParserParseExpressionPair(Parser *parser, Block *parent, int32_t childI, BlockKindId kindId, char *separator,
-    Block *(*innerParseFunction)(Parser *parser, Block *parent, int32_t childI))
-{
-    Block *left = innerParseFunction(parser, parent, childI);
+            Block *right = ParserParseBinaryExpression(parser, block, i, binaryOperator->precedence + 1);
+            BlockReplaceChild(block, right, i, true);
+            i += 1;
+        } while (binaryOperator->isList && ParserHas(parser, operatorKind));
 
-    if (!ParserHas(parser, separator))
-    {
-        return left;
+        left = block;
+        maxPrecedence = binaryOperator->precedence - 1;
     }
-
-    Block *block = BlockNew(kindId, parent, childI);
-
-    BlockReplaceChild(block, left, 0, true);
-    ParserMatch(parser, separator);
-    BlockReplaceChild(block, innerParseFunction(parser, block, 1), 1, true);
-
-    return block;
-}
-
-Block *ParserParseConcatenate(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdConcatenate, "..", ParserParseUnaryPrefix);
-}
-
-Block *ParserParseModulo(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdModulo, "%", ParserParseConcatenate);
-}
-
-Block *ParserParseDivide(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdDivide, "/", ParserParseModulo);
-}
-
-Block *ParserParseMultiply(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdMultiply, "*", ParserParseDivide);
-}
-
-Block *ParserParseSubtract(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdSubtract, "-", ParserParseMultiply);
-}
-
-Block *ParserParseAdd(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdAdd, "+", ParserParseSubtract);
-}
-
-Block *ParserParseGreaterEqual(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionPair(parser, parent, childI, BlockKindIdGreaterEqual, ">=", ParserParseAdd);
-}
-
-Block *ParserParseLessEqual(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionPair(parser, parent, childI, BlockKindIdLessEqual, "<=", ParserParseGreaterEqual);
-}
-
-Block *ParserParseGreater(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionPair(parser, parent, childI, BlockKindIdGreater, ">", ParserParseLessEqual);
-}
-
-Block *ParserParseLess(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionPair(parser, parent, childI, BlockKindIdLess, "<", ParserParseGreater);
-}
-
-Block *ParserParseNotEqual(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdNotEqual, "!=", ParserParseLess);
-}
-
-Block *ParserParseEqual(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdEqual, "==", ParserParseNotEqual);
-}
-
-Block *ParserParseAnd(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdAnd, "and", ParserParseEqual);
-}
-
-Block *ParserParseOr(Parser *parser, Block *parent, int32_t childI)
-{
-    return ParserParseExpressionList(parser, parent, childI, BlockKindIdOr, "or", ParserParseAnd);
 }
 
 Block *ParserParseUnaryPrefix(Parser *parser, Block *parent, int32_t childI)
 {
-    if (ParserHas(parser, "#"))
+    if (ParserHas(parser, TokenKindHash))
     {
-        ParserMatch(parser, "#");
+        ParserMatch(parser, TokenKindHash);
 
-        Block *block = BlockNew(BlockKindIdLength, parent, childI);
+        Block *block = BlockNew(parser->arena, BlockKindIdLength, parent, childI);
 
         BlockReplaceChild(block, ParserParseUnaryPrefix(parser, block, 0), 0, true);
 
         return block;
     }
-    else if (ParserHas(parser, "not"))
+    else if (ParserHas(parser, TokenKindNot))
     {
-        ParserMatch(parser, "not");
+        ParserMatch(parser, TokenKindNot);
 
-        Block *block = BlockNew(BlockKindIdNot, parent, childI);
+        Block *block = BlockNew(parser->arena, BlockKindIdNot, parent, childI);
 
         BlockReplaceChild(block, ParserParseUnaryPrefix(parser, block, 0), 0, true);
 
@@ -499,36 +455,36 @@ Block *ParserParseUnaryPrefix(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseUnarySuffix(Parser *parser, Block *parent, int32_t childI)
 {
-    if (ParserHas(parser, "("))
+    if (ParserHas(parser, TokenKindLeftParenthesis))
     {
         // This is a parenthesized expression.
-        ParserMatch(parser, "(");
+        ParserMatch(parser, TokenKindLeftParenthesis);
 
         Block *expression = ParserParseExpression(parser, parent, childI);
 
-        ParserMatch(parser, ")");
+        ParserMatch(parser, TokenKindRightParenthesis);
 
         return expression;
     }
 
     Block *left = ParserParsePrimary(parser, parent, childI);
 
-    while (ParserHas(parser, "("))
+    while (ParserHas(parser, TokenKindLeftParenthesis))
     {
         // This is a call.
         LexerNext(&parser->lexer);
 
-        Block *call = BlockNew(BlockKindIdCall, parent, childI);
+        Block *call = BlockNew(parser->arena, BlockKindIdCall, parent, childI);
         BlockReplaceChild(call, left, 0, true);
 
         int32_t i = 1;
-        while (!ParserHas(parser, ")"))
+        while (!ParserHas(parser, TokenKindRightParenthesis))
         {
             Block *expression = ParserParseExpression(parser, call, i);
             BlockReplaceChild(call, expression, i, true);
             i += 1;
 
-            if (!ParserHas(parser, ","))
+            if (!ParserHas(parser, TokenKindComma))
             {
                 break;
             }
@@ -536,7 +492,7 @@ Block *ParserParseUnarySuffix(Parser *parser, Block *parent, int32_t childI)
             LexerNext(&parser->lexer);
         }
 
-        ParserMatch(parser, ")");
+        ParserMatch(parser, TokenKindRightParenthesis);
 
         left = call;
     }
@@ -546,11 +502,11 @@ Block *ParserParseUnarySuffix(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParsePrimary(Parser *parser, Block *parent, int32_t childI)
 {
-    if (ParserHas(parser, "function"))
+    if (ParserHas(parser, TokenKindFunction))
     {
         return ParserParseLambdaFunction(parser, parent, childI);
     }
-    else if (ParserHas(parser, "{"))
+    else if (ParserHas(parser, TokenKindLeftBrace))
     {
         return ParserParseTable(parser, parent, childI);
     }
@@ -560,18 +516,18 @@ Block *ParserParsePrimary(Parser *parser, Block *parent, int32_t childI)
 
 Block *ParserParseTable(Parser *parser, Block *parent, int32_t childI)
 {
-    ParserMatch(parser, "{");
+    ParserMatch(parser, TokenKindLeftBrace);
 
-    Block *table = BlockNew(BlockKindIdTable, parent, childI);
+    Block *table = BlockNew(parser->arena, BlockKindIdTable, parent, childI);
 
     int32_t i = 0;
-    while (!ParserHas(parser, "}"))
+    while (!ParserHas(parser, TokenKindRightBrace))
     {
         Block *keyValuePair = ParserParseTableKeyValuePair(parser, table, i);
         BlockReplaceChild(table, keyValuePair, i, true);
         i += 1;
 
-        if (!ParserHas(parser, ","))
+        if (!ParserHas(parser, TokenKindComma))
         {
             break;
         }
@@ -579,7 +535,7 @@ Block *ParserParseTable(Parser *parser, Block *parent, int32_t childI)
         LexerNext(&parser->lexer);
     }
 
-    ParserMatch(parser, "}");
+    ParserMatch(parser, TokenKindRightBrace);
 
     return table;
 }
@@ -591,7 +547,7 @@ Block *ParserParseTableKeyValuePair(Parser *parser, Block *parent, int32_t child
     bool isExpressionValuePair = false;
     BlockKindId pairKindId = BlockKindIdTableKeyValuePair;
 
-    if (ParserHas(parser, "["))
+    if (ParserHas(parser, TokenKindLeftBracket))
     {
         LexerNext(&parser->lexer);
 
@@ -603,19 +559,19 @@ Block *ParserParseTableKeyValuePair(Parser *parser, Block *parent, int32_t child
 
     if (isExpressionValuePair)
     {
-        ParserMatch(parser, "]");
+        ParserMatch(parser, TokenKindRightBracket);
     }
-    else if (!ParserHas(parser, "="))
+    else if (!ParserHas(parser, TokenKindEqual))
     {
-        Block *value = BlockNew(BlockKindIdTableValue, parent, childI);
+        Block *value = BlockNew(parser->arena, BlockKindIdTableValue, parent, childI);
         BlockReplaceChild(value, key, 0, true);
 
         return value;
     }
 
-    ParserMatch(parser, "=");
+    ParserMatch(parser, TokenKindEqual);
 
-    Block *pair = BlockNew(pairKindId, parent, childI);
+    Block *pair = BlockNew(parser->arena, pairKindId, parent, childI);
     BlockReplaceChild(pair, key, 0, true);
     BlockReplaceChild(pair, ParserParseExpression(parser, pair, 1), 1, true);
 
@@ -626,24 +582,24 @@ Block *ParserParseTableKeyValuePair(Parser *parser, Block *parent, int32_t child
 
 Block *ParserParseExpression(Parser *parser, Block *parent, int32_t childI)
 {
-    return ParserParseOr(parser, parent, childI);
+    return ParserParseBinaryExpression(parser, parent, childI, 1);
 }
 
 Block *ParserParseMultiExpression(Parser *parser, Block *parent, int32_t childI)
 {
     Block *expression = ParserParseExpression(parser, parent, childI);
 
-    if (!ParserHas(parser, ","))
+    if (!ParserHas(parser, TokenKindComma))
     {
         return expression;
     }
 
-    Block *expressionList = BlockNew(BlockKindIdExpressionList, parent, childI);
+    Block *expressionList = BlockNew(parser->arena, BlockKindIdExpressionList, parent, childI);
 
     BlockReplaceChild(expressionList, expression, 0, true);
 
     int32_t i = 1;
-    while (ParserHas(parser, ","))
+    while (ParserHas(parser, TokenKindComma))
     {
         LexerNext(&parser->lexer);
 
@@ -654,53 +610,40 @@ Block *ParserParseMultiExpression(Parser *parser, Block *parent, int32_t childI)
     return expressionList;
 }
 
-Block *ParserParseStatement(Parser *parser, Block *parent, int32_t childI)
+static Block *ParserParseAnyStatement(Parser *parser, Block *parent, int32_t childI)
 {
-    Token start = LexerPeek(&parser->lexer);
-
-    if (LexerTokenEquals(&parser->lexer, start, "do", false))
+    switch (LexerPeek(&parser->lexer).kind)
     {
+    case TokenKindDo:
         return ParserParseDo(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "if", false))
-    {
+    case TokenKindIf:
         return ParserParseIf(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "function", false))
-    {
+    case TokenKindFunction:
         return ParserParseFunction(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "for", false))
-    {
+    case TokenKindFor:
         return ParserParseForLoop(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "while", false))
-    {
+    case TokenKindWhile:
         return ParserParseWhileLoop(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "return", false))
-    {
+    case TokenKindReturn:
         return ParserParseReturn(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "local", false))
-    {
+    case TokenKindLocal:
         return ParserParseLocal(parser, parent, childI);
-    }
-    else if (LexerTokenEquals(&parser->lexer, start, "--", true))
-    {
+    case TokenKindComment:
         return ParserParseComment(parser, parent, childI);
+    default:
+        break;
     }
 
     Block *expression = ParserParseMultiExpression(parser, parent, childI);
 
-    if (!ParserHas(parser, "=") && expression->kindId != BlockKindIdExpressionList)
+    if (!ParserHas(parser, TokenKindEqual) && expression->kindId != BlockKindIdExpressionList)
     {
         return expression;
     }
 
-    ParserMatch(parser, "=");
+    ParserMatch(parser, TokenKindEqual);
 
-    Block *assign = BlockNew(BlockKindIdAssign, parent, childI);
+    Block *assign = BlockNew(parser->arena, BlockKindIdAssign, parent, childI);
     Block *rightExpression = ParserParseMultiExpression(parser, assign, 1);
     BlockReplaceChild(assign, expression, 0, true);
     BlockReplaceChild(assign, rightExpression, 1, true);
@@ -708,24 +651,53 @@ Block *ParserParseStatement(Parser *parser, Block *parent, int32_t childI)
     return assign;
 }
 
+Block *ParserParseStatement(Parser *parser, Block *parent, int32_t childI)
+{
+    // Only the top level statements are traced, tracing every statement would bury them in tiny scopes.
+    bool isTopLevel = !parent || !parent->parent;
+
+    if (isTopLevel)
+    {
+        TracerBegin("ParserParseStatement");
+    }
+
+    Block *statement = ParserParseAnyStatement(parser, parent, childI);
+
+    if (isTopLevel)
+    {
+        TracerEnd("ParserParseStatement");
+    }
+
+    return statement;
+}
+
 // TODO: Simplify identifiers, ie: table.field should not be an identifier, it should be (. table field) where table and
 // field are separate identifiers.
 Block *ParserParseIdentifier(Parser *parser, Block *parent, int32_t childI)
 {
     Token text = LexerNext(&parser->lexer);
-    int32_t textCount = text.end - text.start;
+    int32_t textCount = text.length;
+    char *textStart = LexerGetTokenText(&parser->lexer, text);
 
-    ListReset_char(&parser->textBuffer);
-    ListReserve_char(&parser->textBuffer, textCount);
+    assert(textCount >= 0);
 
-    char firstChar = parser->lexer.data[text.start];
+    char firstChar = textCount > 0 ? textStart[0] : '\0';
     bool doConvert = firstChar != '"' && firstChar != '\'';
 
+    // Text that doesn't need converting is interned straight from the source, which may avoid copying it.
+    if (!doConvert || !memchr(textStart, '_', (size_t)textCount))
+    {
+        return BlockNewIdentifier(parser->arena, textStart, textCount, parent, childI);
+    }
+
+    ListReset_char(&parser->textBuffer);
+    ListReserve_char(&parser->textBuffer, textCount);
+
     for (int32_t i = 0; i < textCount; i++)
     {
-        char textChar = parser->lexer.data[text.start + i];
+        char textChar = textStart[i];
 
-        if (doConvert && textChar == '_')
+        if (textChar == '_')
         {
             textChar = ' ';
         }
@@ -733,7 +705,8 @@ Block *ParserParseIdentifier(Parser *parser, Block *parent, int32_t childI)
         ListPush_char(&parser->textBuffer, textChar);
     }
 
-    Block *block = BlockNewIdentifier(parser->textBuffer.data, parser->textBuffer.count, parser->font, parent, childI);
+    Block *block =
+        BlockNewIdentifier(parser->arena, parser->textBuffer.data, parser->textBuffer.count, parent, childI);
 
     return block;
 }
\ No newline at end of file
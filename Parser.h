@@ -7,16 +7,16 @@
 typedef struct Parser
 {
     Lexer lexer;
-    Font *font;
+    BlockArena *arena;
     List_char textBuffer;
 } Parser;
 
-Parser ParserNew(Lexer lexer, Font *font);
+Parser ParserNew(Lexer lexer, BlockArena *arena);
 void ParserDelete(Parser *parser);
 
-void ParserMatch(Parser *parser, char *string);
-bool ParserHas(Parser *parser, char *string);
-void ParserList(Parser *parser, Block *parent, Block *(*ParserFunction)(Parser *parser, Block *parent, int32_t childI), int32_t startI, char *end, char *separator);
+void ParserMatch(Parser *parser, TokenKind kind);
+bool ParserHas(Parser *parser, TokenKind kind);
+void ParserList(Parser *parser, Block *parent, Block *(*ParserFunction)(Parser *parser, Block *parent, int32_t childI), int32_t startI, TokenKind end, TokenKind separator);
 
 Block *ParserParseDo(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParseCase(Parser *parser, Block *parent, int32_t childI);
@@ -34,20 +34,6 @@ Block *ParserParseFunctionHeader(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParseFunction(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParseLambdaFunctionHeader(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParseLambdaFunction(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseConcatenate(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseModulo(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseDivide(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseMultiply(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseSubtract(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseAdd(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseGreaterEqual(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseLessEqual(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseGreater(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseLess(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseNotEqual(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseEqual(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseAnd(Parser *parser, Block *parent, int32_t childI);
-Block *ParserParseOr(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParseUnaryPrefix(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParseUnarySuffix(Parser *parser, Block *parent, int32_t childI);
 Block *ParserParsePrimary(Parser *parser, Block *parent, int32_t childI);
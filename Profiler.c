@@ -0,0 +1,137 @@
+#include "Profiler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// How many frames of history are kept for each phase.
+#define PROFILER_HISTORY_SIZE 256
+
+const char *ProfilerPhaseNames[ProfilerPhaseCount] = {
+    [ProfilerPhaseCursorUpdate] = "CursorUpdate",
+    [ProfilerPhaseBlockUpdateTree] = "BlockUpdateTree",
+    [ProfilerPhaseBlockUpdateMesh] = "BlockUpdateMesh",
+    [ProfilerPhaseCameraUpdate] = "CameraUpdate",
+    [ProfilerPhaseBlockDraw] = "BlockDraw",
+    [ProfilerPhaseCursorDraw] = "CursorDraw",
+    [ProfilerPhaseFontUpdate] = "FontUpdate",
+    [ProfilerPhaseFlush] = "Flush",
+};
+
+const char *ProfilerCounterNames[ProfilerCounterCount] = {
+    [ProfilerCounterBlocksVisited] = "Blocks visited",
+    [ProfilerCounterBlocksCulled] = "Blocks culled",
+    [ProfilerCounterBlocksCollapsed] = "Blocks collapsed",
+    [ProfilerCounterRectsDrawn] = "Rects drawn",
+    [ProfilerCounterRectsRewritten] = "Rects rewritten",
+    [ProfilerCounterRectsUploaded] = "Rects uploaded",
+    [ProfilerCounterGlyphsDrawn] = "Glyphs drawn",
+    [ProfilerCounterAtlasPages] = "Atlas pages",
+    [ProfilerCounterGlyphsRasterized] = "Glyphs rasterized",
+    [ProfilerCounterGlyphsEvicted] = "Glyphs evicted",
+    [ProfilerCounterAtlasPixelsUploaded] = "Atlas pixels uploaded",
+};
+
+typedef struct Profiler
+{
+    double phaseStartTimes[ProfilerPhaseCount];
+    double phaseTimes[ProfilerPhaseCount];
+    // Rolling history of each phase's time in seconds, one entry per frame.
+    double phaseHistory[ProfilerPhaseCount][PROFILER_HISTORY_SIZE];
+    int32_t historyI;
+    int32_t historyCount;
+
+    int64_t counters[ProfilerCounterCount];
+    // Counters from the last finished frame, so that they can be shown while the next one is in progress.
+    int64_t lastCounters[ProfilerCounterCount];
+} Profiler;
+
+static Profiler GlobalProfiler;
+
+double ProfilerGetTime(void)
+{
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+void ProfilerBeginPhase(ProfilerPhase phase)
+{
+    GlobalProfiler.phaseStartTimes[phase] = ProfilerGetTime();
+}
+
+// Phases can be entered more than once per frame, their times are added together.
+void ProfilerEndPhase(ProfilerPhase phase)
+{
+    GlobalProfiler.phaseTimes[phase] += ProfilerGetTime() - GlobalProfiler.phaseStartTimes[phase];
+}
+
+void ProfilerCount(ProfilerCounter counter, int64_t amount)
+{
+    GlobalProfiler.counters[counter] += amount;
+}
+
+void ProfilerEndFrame(void)
+{
+    for (int32_t i = 0; i < ProfilerPhaseCount; i++)
+    {
+        GlobalProfiler.phaseHistory[i][GlobalProfiler.historyI] = GlobalProfiler.phaseTimes[i];
+        GlobalProfiler.phaseTimes[i] = 0.0;
+    }
+
+    GlobalProfiler.historyI = (GlobalProfiler.historyI + 1) % PROFILER_HISTORY_SIZE;
+
+    if (GlobalProfiler.historyCount < PROFILER_HISTORY_SIZE)
+    {
+        GlobalProfiler.historyCount += 1;
+    }
+
+    memcpy(GlobalProfiler.lastCounters, GlobalProfiler.counters, sizeof(GlobalProfiler.counters));
+    memset(GlobalProfiler.counters, 0, sizeof(GlobalProfiler.counters));
+}
+
+static int ProfilerCompareTimes(const void *a, const void *b)
+{
+    double timeA = *(const double *)a;
+    double timeB = *(const double *)b;
+
+    return (timeA > timeB) - (timeA < timeB);
+}
+
+ProfilerPhaseStats ProfilerGetPhaseStats(ProfilerPhase phase)
+{
+    if (GlobalProfiler.historyCount == 0)
+    {
+        return (ProfilerPhaseStats){0};
+    }
+
+    double sortedTimes[PROFILER_HISTORY_SIZE];
+    memcpy(sortedTimes, GlobalProfiler.phaseHistory[phase], GlobalProfiler.historyCount * sizeof(double));
+    qsort(sortedTimes, GlobalProfiler.historyCount, sizeof(double), ProfilerCompareTimes);
+
+    double totalTime = 0.0;
+
+    for (int32_t i = 0; i < GlobalProfiler.historyCount; i++)
+    {
+        totalTime += sortedTimes[i];
+    }
+
+    int32_t p99I = (GlobalProfiler.historyCount * 99) / 100;
+
+    if (p99I >= GlobalProfiler.historyCount)
+    {
+        p99I = GlobalProfiler.historyCount - 1;
+    }
+
+    return (ProfilerPhaseStats){
+        .min = sortedTimes[0],
+        .average = totalTime / GlobalProfiler.historyCount,
+        .p99 = sortedTimes[p99I],
+    };
+}
+
+int64_t ProfilerGetCounter(ProfilerCounter counter)
+{
+    return GlobalProfiler.lastCounters[counter];
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+typedef enum ProfilerPhase
+{
+    ProfilerPhaseCursorUpdate,
+    ProfilerPhaseBlockUpdateTree,
+    ProfilerPhaseBlockUpdateMesh,
+    ProfilerPhaseCameraUpdate,
+    ProfilerPhaseBlockDraw,
+    ProfilerPhaseCursorDraw,
+    ProfilerPhaseFontUpdate,
+    ProfilerPhaseFlush,
+    ProfilerPhaseCount,
+} ProfilerPhase;
+
+typedef enum ProfilerCounter
+{
+    ProfilerCounterBlocksVisited,
+    ProfilerCounterBlocksCulled,
+    ProfilerCounterBlocksCollapsed,
+    ProfilerCounterRectsDrawn,
+    ProfilerCounterRectsRewritten,
+    ProfilerCounterRectsUploaded,
+    ProfilerCounterGlyphsDrawn,
+    ProfilerCounterAtlasPages,
+    ProfilerCounterGlyphsRasterized,
+    ProfilerCounterGlyphsEvicted,
+    ProfilerCounterAtlasPixelsUploaded,
+    ProfilerCounterCount,
+} ProfilerCounter;
+
+typedef struct ProfilerPhaseStats
+{
+    double min;
+    double average;
+    double p99;
+} ProfilerPhaseStats;
+
+extern const char *ProfilerPhaseNames[ProfilerPhaseCount];
+extern const char *ProfilerCounterNames[ProfilerCounterCount];
+
+double ProfilerGetTime(void);
+void ProfilerBeginPhase(ProfilerPhase phase);
+void ProfilerEndPhase(ProfilerPhase phase);
+void ProfilerCount(ProfilerCounter counter, int64_t amount);
+void ProfilerEndFrame(void);
+ProfilerPhaseStats ProfilerGetPhaseStats(ProfilerPhase phase);
+int64_t ProfilerGetCounter(ProfilerCounter counter);
\ No newline at end of file
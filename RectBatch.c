@@ -0,0 +1,386 @@
+#include "RectBatch.h"
+#include "List.h"
+#include "Math.h"
+#include "Profiler.h"
+
+#include <sokol_gfx.h>
+
+// GLFW includes the system's OpenGL header, and loads the buffer functions it doesn't declare on every platform.
+#include "GLFW/glfw3.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+
+#if defined(_WIN32)
+#define RECT_BATCH_GL_CALL __stdcall
+#else
+#define RECT_BATCH_GL_CALL
+#endif
+
+typedef void(RECT_BATCH_GL_CALL *RectBatchBindBufferFunction)(GLenum target, GLuint buffer);
+typedef void(RECT_BATCH_GL_CALL *RectBatchBufferSubDataFunction)(
+    GLenum target, ptrdiff_t offset, ptrdiff_t size, const void *data);
+
+static RectBatchBindBufferFunction RectBatchBindBuffer;
+static RectBatchBufferSubDataFunction RectBatchBufferSubData;
+
+static const int32_t RectBatchInitialCapacity = 4096;
+// Dirty rects closer together than this are uploaded in one range, rather than issuing an upload for each.
+static const int32_t RectBatchMaxUploadGap = 16;
+
+typedef struct RectInstance
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    uint32_t color;
+} RectInstance;
+
+ListDefine(RectInstance);
+
+typedef struct RectBatchUniforms
+{
+    // The offset in xy and the scale in z, matching the transform used with sokol_gp.
+    float transform[4];
+    float screenSize[4];
+} RectBatchUniforms;
+
+// Every rect in the batch is drawn at once, using a single quad instanced once per rect.
+// Normal batches are refilled each frame, retained batches keep their rects between frames
+// and only the rects that changed are uploaded again.
+typedef struct RectBatch
+{
+    List_RectInstance instances;
+    bool isRetained;
+    bool needsUpload;
+    // Rects in a retained batch that were set since the last upload, possibly more than once and out of order.
+    List_int32_t dirtyIndices;
+
+    sg_buffer cornerBuffer;
+    sg_buffer instanceBuffer;
+    int32_t instanceBufferCapacity;
+
+    sg_shader shader;
+    sg_pipeline pipeline;
+} RectBatch;
+
+static const char *RectBatchVertexSource =
+    "#version 330\n"
+    "uniform vec4 transform;\n"
+    "uniform vec4 screenSize;\n"
+    "in vec2 corner;\n"
+    "in vec4 rect;\n"
+    "in vec4 color;\n"
+    "out vec4 fragmentColor;\n"
+    "void main()\n"
+    "{\n"
+    "    vec2 position = (rect.xy + corner * rect.zw) * transform.z + transform.xy;\n"
+    "    vec2 clipPosition = position / screenSize.xy * vec2(2.0, -2.0) + vec2(-1.0, 1.0);\n"
+    "    gl_Position = vec4(clipPosition, 0.0, 1.0);\n"
+    "    fragmentColor = color;\n"
+    "}\n";
+
+static const char *RectBatchFragmentSource =
+    "#version 330\n"
+    "in vec4 fragmentColor;\n"
+    "out vec4 outputColor;\n"
+    "void main()\n"
+    "{\n"
+    "    outputColor = fragmentColor;\n"
+    "}\n";
+
+// Sokol's dynamic buffers rotate between copies for each frame in flight, so they can only be uploaded whole.
+// Retained batches use an immutable buffer instead, which only has one copy, and update ranges of it directly.
+// It's created with every rect in the batch, and the unused space after them zeroed so those rects are empty.
+static sg_buffer RectBatchMakeInstanceBuffer(RectBatch *batch)
+{
+    size_t bufferSize = (size_t)batch->instanceBufferCapacity * sizeof(RectInstance);
+
+    sg_buffer_desc bufferDescriptor = (sg_buffer_desc){
+        .size = bufferSize,
+        .type = SG_BUFFERTYPE_VERTEXBUFFER,
+        .usage = SG_USAGE_STREAM,
+    };
+
+    if (batch->isRetained)
+    {
+        List_RectInstance *instances = &batch->instances;
+        ListReserve_RectInstance(instances, batch->instanceBufferCapacity);
+        memset(instances->data + instances->count, 0,
+            (size_t)(batch->instanceBufferCapacity - instances->count) * sizeof(RectInstance));
+
+        bufferDescriptor.usage = SG_USAGE_IMMUTABLE;
+        bufferDescriptor.data = (sg_range){
+            .ptr = instances->data,
+            .size = bufferSize,
+        };
+
+        ListReset_int32_t(&batch->dirtyIndices);
+        ProfilerCount(ProfilerCounterRectsUploaded, batch->instanceBufferCapacity);
+    }
+
+    return sg_make_buffer(&bufferDescriptor);
+}
+
+RectBatch *RectBatchNew(bool isRetained)
+{
+    RectBatch *batch = malloc(sizeof(RectBatch));
+    *batch = (RectBatch){
+        .instances = ListNew_RectInstance(RectBatchInitialCapacity),
+        .isRetained = isRetained,
+        .dirtyIndices = ListNew_int32_t(RectBatchInitialCapacity),
+        .instanceBufferCapacity = RectBatchInitialCapacity,
+    };
+
+    if (!RectBatchBufferSubData)
+    {
+        RectBatchBindBuffer = (RectBatchBindBufferFunction)glfwGetProcAddress("glBindBuffer");
+        RectBatchBufferSubData = (RectBatchBufferSubDataFunction)glfwGetProcAddress("glBufferSubData");
+        assert(RectBatchBindBuffer && RectBatchBufferSubData);
+    }
+
+    // Two triangles covering the unit square.
+    float corners[] = {0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 0, 1};
+
+    sg_buffer_desc cornerBufferDescriptor = (sg_buffer_desc){
+        .data = SG_RANGE(corners),
+    };
+    batch->cornerBuffer = sg_make_buffer(&cornerBufferDescriptor);
+    batch->instanceBuffer = RectBatchMakeInstanceBuffer(batch);
+
+    sg_shader_desc shaderDescriptor = (sg_shader_desc){
+        .attrs =
+            {
+                [0].name = "corner",
+                [1].name = "rect",
+                [2].name = "color",
+            },
+        .vs =
+            {
+                .source = RectBatchVertexSource,
+                .uniform_blocks[0] =
+                    {
+                        .size = sizeof(RectBatchUniforms),
+                        .uniforms =
+                            {
+                                [0] = {.name = "transform", .type = SG_UNIFORMTYPE_FLOAT4},
+                                [1] = {.name = "screenSize", .type = SG_UNIFORMTYPE_FLOAT4},
+                            },
+                    },
+            },
+        .fs.source = RectBatchFragmentSource,
+    };
+    batch->shader = sg_make_shader(&shaderDescriptor);
+
+    sg_pipeline_desc pipelineDescriptor = (sg_pipeline_desc){
+        .shader = batch->shader,
+        .layout =
+            {
+                .buffers[1].step_func = SG_VERTEXSTEP_PER_INSTANCE,
+                .attrs =
+                    {
+                        [0] = {.buffer_index = 0, .format = SG_VERTEXFORMAT_FLOAT2},
+                        [1] = {.buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4},
+                        [2] = {.buffer_index = 1,
+                            .offset = offsetof(RectInstance, color),
+                            .format = SG_VERTEXFORMAT_UBYTE4N},
+                    },
+            },
+        .colors[0].blend =
+            {
+                .enabled = true,
+                .src_factor_rgb = SG_BLENDFACTOR_SRC_ALPHA,
+                .dst_factor_rgb = SG_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+            },
+    };
+    batch->pipeline = sg_make_pipeline(&pipelineDescriptor);
+
+    return batch;
+}
+
+void RectBatchDelete(RectBatch *batch)
+{
+    sg_destroy_pipeline(batch->pipeline);
+    sg_destroy_shader(batch->shader);
+    sg_destroy_buffer(batch->instanceBuffer);
+    sg_destroy_buffer(batch->cornerBuffer);
+
+    ListDelete_int32_t(&batch->dirtyIndices);
+    ListDelete_RectInstance(&batch->instances);
+    free(batch);
+}
+
+static uint32_t RectBatchPackColor(Color color)
+{
+    uint32_t r = (uint32_t)(color.r * 255.0f + 0.5f);
+    uint32_t g = (uint32_t)(color.g * 255.0f + 0.5f);
+    uint32_t b = (uint32_t)(color.b * 255.0f + 0.5f);
+    uint32_t a = (uint32_t)(color.a * 255.0f + 0.5f);
+
+    return r | g << 8 | b << 16 | a << 24;
+}
+
+// Positions are in world space, they're transformed when the batch is drawn.
+void RectBatchPush(RectBatch *batch, float x, float y, float width, float height, Color color)
+{
+    RectInstance instance = {
+        .x = x,
+        .y = y,
+        .width = width,
+        .height = height,
+        .color = RectBatchPackColor(color),
+    };
+
+    ListPush_RectInstance(&batch->instances, instance);
+    batch->needsUpload = true;
+}
+
+// Overwrites the rect at i in a retained batch, rects that haven't been set yet are empty.
+void RectBatchSet(RectBatch *batch, int32_t i, float x, float y, float width, float height, Color color)
+{
+    while (batch->instances.count <= i)
+    {
+        ListPush_RectInstance(&batch->instances, (RectInstance){0});
+    }
+
+    batch->instances.data[i] = (RectInstance){
+        .x = x,
+        .y = y,
+        .width = width,
+        .height = height,
+        .color = RectBatchPackColor(color),
+    };
+    ListPush_int32_t(&batch->dirtyIndices, i);
+}
+
+void RectBatchGetPosition(RectBatch *batch, int32_t i, float *x, float *y)
+{
+    if (i >= batch->instances.count)
+    {
+        *x = 0;
+        *y = 0;
+        return;
+    }
+
+    *x = batch->instances.data[i].x;
+    *y = batch->instances.data[i].y;
+}
+
+static int RectBatchCompareIndices(const void *a, const void *b)
+{
+    int32_t indexA = *(const int32_t *)a;
+    int32_t indexB = *(const int32_t *)b;
+
+    return (indexA > indexB) - (indexA < indexB);
+}
+
+// Uploads the rects that were set since the last upload, merged into ranges so that nearby rects share one upload.
+static void RectBatchUploadDirtyRects(RectBatch *batch)
+{
+    List_int32_t *dirtyIndices = &batch->dirtyIndices;
+
+    if (dirtyIndices->count == 0)
+    {
+        return;
+    }
+
+    qsort(dirtyIndices->data, (size_t)dirtyIndices->count, sizeof(int32_t), RectBatchCompareIndices);
+
+    sg_gl_buffer_info bufferInfo = sg_gl_query_buffer_info(batch->instanceBuffer);
+    RectBatchBindBuffer(GL_ARRAY_BUFFER, bufferInfo.buf[bufferInfo.active_slot]);
+
+    int32_t rangeStart = dirtyIndices->data[0];
+    int32_t rangeEnd = rangeStart + 1;
+
+    for (int32_t i = 1; i <= dirtyIndices->count; i++)
+    {
+        if (i < dirtyIndices->count && dirtyIndices->data[i] <= rangeEnd + RectBatchMaxUploadGap)
+        {
+            rangeEnd = MathInt32Max(rangeEnd, dirtyIndices->data[i] + 1);
+            continue;
+        }
+
+        ProfilerCount(ProfilerCounterRectsUploaded, rangeEnd - rangeStart);
+        RectBatchBufferSubData(GL_ARRAY_BUFFER, (ptrdiff_t)rangeStart * (ptrdiff_t)sizeof(RectInstance),
+            (ptrdiff_t)(rangeEnd - rangeStart) * (ptrdiff_t)sizeof(RectInstance), batch->instances.data + rangeStart);
+
+        if (i < dirtyIndices->count)
+        {
+            rangeStart = dirtyIndices->data[i];
+            rangeEnd = rangeStart + 1;
+        }
+    }
+
+    ListReset_int32_t(dirtyIndices);
+
+    // Sokol caches which buffer is bound, and it was just changed behind it's back.
+    sg_reset_state_cache();
+}
+
+// Draws every rect in the batch, normal batches are cleared afterwards.
+// This needs to be called at most once per frame within a pass, since the batch's buffer can only be updated once.
+void RectBatchDraw(RectBatch *batch, float x, float y, float scale, float screenWidth, float screenHeight)
+{
+    int32_t instanceCount = batch->instances.count;
+
+    if (instanceCount == 0)
+    {
+        return;
+    }
+
+    ProfilerCount(ProfilerCounterRectsDrawn, instanceCount);
+
+    if (instanceCount > batch->instanceBufferCapacity)
+    {
+        while (batch->instanceBufferCapacity < instanceCount)
+        {
+            batch->instanceBufferCapacity *= 2;
+        }
+
+        sg_destroy_buffer(batch->instanceBuffer);
+        batch->instanceBuffer = RectBatchMakeInstanceBuffer(batch);
+        batch->needsUpload = true;
+    }
+
+    if (batch->isRetained)
+    {
+        RectBatchUploadDirtyRects(batch);
+    }
+    else if (batch->needsUpload)
+    {
+        sg_range instanceData = {
+            .ptr = batch->instances.data,
+            .size = (size_t)instanceCount * sizeof(RectInstance),
+        };
+        sg_update_buffer(batch->instanceBuffer, &instanceData);
+
+        batch->needsUpload = false;
+    }
+
+    RectBatchUniforms uniforms = {
+        .transform = {x, y, scale, 0},
+        .screenSize = {screenWidth, screenHeight, 0, 0},
+    };
+
+    sg_bindings bindings = {
+        .vertex_buffers[0] = batch->cornerBuffer,
+        .vertex_buffers[1] = batch->instanceBuffer,
+    };
+
+    sg_apply_pipeline(batch->pipeline);
+    sg_apply_bindings(&bindings);
+    sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, &SG_RANGE(uniforms));
+    sg_draw(0, 6, instanceCount);
+
+    if (!batch->isRetained)
+    {
+        ListReset_RectInstance(&batch->instances);
+    }
+}
\ No newline at end of file
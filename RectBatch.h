@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Color.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+typedef struct RectBatch RectBatch;
+
+RectBatch *RectBatchNew(bool isRetained);
+void RectBatchDelete(RectBatch *batch);
+void RectBatchPush(RectBatch *batch, float x, float y, float width, float height, Color color);
+void RectBatchSet(RectBatch *batch, int32_t i, float x, float y, float width, float height, Color color);
+void RectBatchGetPosition(RectBatch *batch, int32_t i, float *x, float *y);
+void RectBatchDraw(RectBatch *batch, float x, float y, float scale, float screenWidth, float screenHeight);
\ No newline at end of file
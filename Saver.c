@@ -1,5 +1,6 @@
 #include "Saver.h"
 #include "Block.h"
+#include "Tracer.h"
 
 Saver SaverNew(void)
 {
@@ -18,13 +19,20 @@ void SaverReset(Saver *saver)
     WriterReset(&saver->writer);
 }
 
-void SaverSave(Saver *saver, Block *block)
+static void SaverSaveBlock(Saver *saver, Block *block)
 {
     BlockKind *kind = &BlockKinds[block->kindId];
 
     kind->save(saver, block);
 }
 
+void SaverSave(Saver *saver, Block *block)
+{
+    TracerBegin("SaverSave");
+    SaverSaveBlock(saver, block);
+    TracerEnd("SaverSave");
+}
+
 static void SaverSaveBlockList(Saver *saver, Block *block, int32_t firstI, char *seperator)
 {
     int32_t childrenCount = BlockGetChildrenCount(block);
@@ -33,7 +41,7 @@ static void SaverSaveBlockList(Saver *saver, Block *block, int32_t firstI, char
     {
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
 
         if (i < childrenCount - 1)
         {
@@ -58,7 +66,7 @@ void SaverSaveDo(Saver *saver, Block *block)
     {
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
         WriterNewline(&saver->writer);
     }
 
@@ -74,7 +82,7 @@ void SaverSaveStatementList(Saver *saver, Block *block)
     {
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
         WriterNewline(&saver->writer);
     }
 }
@@ -82,7 +90,7 @@ void SaverSaveStatementList(Saver *saver, Block *block)
 void SaverSaveFunctionHeader(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "function ");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, "(");
     SaverSaveBlockList(saver, block, 1, ", ");
     WriterWriteLine(&saver->writer, ")");
@@ -90,9 +98,9 @@ void SaverSaveFunctionHeader(Saver *saver, Block *block)
 
 void SaverSaveFunction(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterIndent(&saver->writer);
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterUnindent(&saver->writer);
     WriterWrite(&saver->writer, "end");
 }
@@ -107,16 +115,16 @@ void SaverSaveLambdaFunctionHeader(Saver *saver, Block *block)
 
 void SaverSaveLambdaFunction(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterIndent(&saver->writer);
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterUnindent(&saver->writer);
     WriterWriteLine(&saver->writer, "end");
 }
 
 void SaverSaveCase(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWriteLine(&saver->writer, " then");
 
     WriterIndent(&saver->writer);
@@ -127,7 +135,7 @@ void SaverSaveCase(Saver *saver, Block *block)
     {
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
         WriterNewline(&saver->writer);
     }
 
@@ -151,7 +159,7 @@ void SaverSaveIfCases(Saver *saver, Block *block)
 
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
     }
 }
 
@@ -166,7 +174,7 @@ void SaverSaveElseCase(Saver *saver, Block *block)
     {
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
         WriterNewline(&saver->writer);
     }
 
@@ -175,13 +183,13 @@ void SaverSaveElseCase(Saver *saver, Block *block)
 
 void SaverSaveIf(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
 
     Block *elseBlock = BlockGetChild(block, 1);
 
     if (BlockContainsNonPin(elseBlock))
     {
-        SaverSave(saver, elseBlock);
+        SaverSaveBlock(saver, elseBlock);
     }
 
     WriterWrite(&saver->writer, "end");
@@ -194,27 +202,27 @@ void SaverSaveExpressionList(Saver *saver, Block *block)
 
 void SaverSaveAssign(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " = ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
 }
 
 void SaverSaveComment(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "-- ");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
 }
 
 void SaverSaveNot(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "not ");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
 }
 
 void SaverSaveLength(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "#");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
 }
 
 void SaverSaveConcatenate(Saver *saver, Block *block)
@@ -262,36 +270,36 @@ void SaverSaveSubtract(Saver *saver, Block *block)
 void SaverSaveGreaterEqual(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "(");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " >= ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterWrite(&saver->writer, ")");
 }
 
 void SaverSaveLessEqual(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "(");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " <= ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterWrite(&saver->writer, ")");
 }
 
 void SaverSaveGreater(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "(");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " > ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterWrite(&saver->writer, ")");
 }
 
 void SaverSaveLess(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "(");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " < ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterWrite(&saver->writer, ")");
 }
 
@@ -325,7 +333,7 @@ void SaverSaveOr(Saver *saver, Block *block)
 
 void SaverSaveCall(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
 
     WriterWrite(&saver->writer, "(");
 
@@ -336,17 +344,17 @@ void SaverSaveCall(Saver *saver, Block *block)
 
 void SaverSaveIdentifier(Saver *saver, Block *block)
 {
-    WriterWriteIdentifier(&saver->writer, block->data.identifier.text);
+    WriterWriteIdentifier(&saver->writer, block->identifier->text, block->identifier->textLength);
 }
 
 void SaverSaveForLoop(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "for ");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWriteLine(&saver->writer, " do");
 
     WriterIndent(&saver->writer);
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterUnindent(&saver->writer);
 
     WriterWrite(&saver->writer, "end");
@@ -354,41 +362,41 @@ void SaverSaveForLoop(Saver *saver, Block *block)
 
 void SaverSaveForLoopCondition(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " = ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
 }
 
 void SaverSaveForLoopBounds(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, ", ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
 
     Block *stepBlock = BlockGetChild(block, 2);
 
     if (stepBlock->kindId != BlockKindIdPin)
     {
         WriterWrite(&saver->writer, ", ");
-        SaverSave(saver, BlockGetChild(block, 2));
+        SaverSaveBlock(saver, BlockGetChild(block, 2));
     }
 }
 
 void SaverSaveForInLoopCondition(Saver *saver, Block *block)
 {
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " in ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
 }
 
 void SaverSaveWhileLoop(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "while ");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWriteLine(&saver->writer, " do");
 
     WriterIndent(&saver->writer);
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterUnindent(&saver->writer);
 
     WriterWrite(&saver->writer, "end");
@@ -403,7 +411,7 @@ void SaverSaveReturn(Saver *saver, Block *block)
 void SaverSaveLocal(Saver *saver, Block *block)
 {
     WriterWrite(&saver->writer, "local ");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
 }
 
 void SaverSaveTable(Saver *saver, Block *block)
@@ -418,7 +426,7 @@ void SaverSaveTable(Saver *saver, Block *block)
 
         Block *child = BlockGetChild(block, i);
 
-        SaverSave(saver, child);
+        SaverSaveBlock(saver, child);
     }
 
     WriterUnindent(&saver->writer);
@@ -432,9 +440,9 @@ void SaverSaveTableKeyValuePair(Saver *saver, Block *block)
         return;
     }
 
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, " = ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterWriteLine(&saver->writer, ",");
 }
 
@@ -446,9 +454,9 @@ void SaverSaveTableExpressionValuePair(Saver *saver, Block *block)
     }
 
     WriterWrite(&saver->writer, "[");
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWrite(&saver->writer, "] = ");
-    SaverSave(saver, BlockGetChild(block, 1));
+    SaverSaveBlock(saver, BlockGetChild(block, 1));
     WriterWriteLine(&saver->writer, ",");
 }
 
@@ -459,6 +467,6 @@ void SaverSaveTableValue(Saver *saver, Block *block)
         return;
     }
 
-    SaverSave(saver, BlockGetChild(block, 0));
+    SaverSaveBlock(saver, BlockGetChild(block, 0));
     WriterWriteLine(&saver->writer, ",");
 }
\ No newline at end of file
@@ -262,6 +262,8 @@ void SearchBarDraw(SearchBar *searchBar, Camera *camera, Font *font, Theme *them
 
     ColorSet(theme->textColor);
     FontDraw(searchBar->text.data, MathFloatFloor(textX * camera->zoom), MathFloatFloor(textY * camera->zoom), font);
+    // Text is queued until it's flushed, so it's flushed before anything else is drawn over it.
+    FontFlush(font);
 
     ListPop_char(&searchBar->text);
 
@@ -293,6 +295,7 @@ void SearchBarDraw(SearchBar *searchBar, Camera *camera, Font *font, Theme *them
 
         ColorSet(theme->textColor);
         FontDraw(result, MathFloatFloor(textX * camera->zoom), MathFloatFloor(resultTextY * camera->zoom), font);
+        FontFlush(font);
 
         y += resultBackground.height;
     }
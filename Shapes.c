@@ -1,5 +1,6 @@
 #include "Shapes.h"
 #include "Math.h"
+#include "Profiler.h"
 
 #include <sokol_gfx.h>
 #include <sokol_gp.h>
@@ -8,11 +9,13 @@
 
 void DrawRect(float x, float y, float width, float height, float scale)
 {
+    ProfilerCount(ProfilerCounterRectsDrawn, 1);
     sgp_draw_filled_rect(x * scale, y * scale, width * scale, height * scale);
 }
 
 void DrawRectBordered(float x, float y, float width, float height, float scale, float outline)
 {
+    ProfilerCount(ProfilerCounterRectsDrawn, 1);
     outline = MathFloatCeil(outline * scale);
     sgp_draw_filled_rect(x * scale - outline, y * scale - outline, width * scale + outline * 2, height * scale + outline * 2);
 }
@@ -0,0 +1,289 @@
+#include "StringTable.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int32_t StringTableInitialCapacity = 1024;
+static const size_t StringTableChunkSize = 64 * 1024;
+
+typedef struct StringTableChunk StringTableChunk;
+
+typedef struct StringTableChunk
+{
+    StringTableChunk *next;
+    // Marks where the strings start, keeping them aligned.
+    double alignment;
+} StringTableChunk;
+
+typedef struct StringTable
+{
+    // Open addressing, the capacity is always a power of two.
+    InternedString **slots;
+    int32_t capacity;
+    int32_t count;
+
+    StringTableChunk *chunks;
+    uint8_t *nextItem;
+    uint8_t *chunkEnd;
+
+    // Strings interned from text inside of the source point into it instead of being copied.
+    const char *sourceData;
+    int64_t sourceDataCount;
+} StringTable;
+
+static StringTable Table;
+
+void StringTableInit(void)
+{
+    Table = (StringTable){
+        .slots = calloc(StringTableInitialCapacity, sizeof(InternedString *)),
+        .capacity = StringTableInitialCapacity,
+    };
+
+    assert(Table.slots);
+}
+
+void StringTableDeinit(void)
+{
+    StringTableChunk *chunk = Table.chunks;
+
+    while (chunk)
+    {
+        StringTableChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(Table.slots);
+    Table = (StringTable){0};
+}
+
+static uint32_t StringTableHash(const char *text, int32_t textLength)
+{
+    // FNV-1a.
+    uint32_t hash = 2166136261u;
+
+    for (int32_t i = 0; i < textLength; i++)
+    {
+        hash ^= (uint8_t)text[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Strings are bump allocated together with their text, and never freed individually.
+static void *StringTableAllocate(size_t size)
+{
+    size = (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+
+    if ((size_t)(Table.chunkEnd - Table.nextItem) < size)
+    {
+        size_t chunkSize = offsetof(StringTableChunk, alignment) + size;
+
+        if (chunkSize < StringTableChunkSize)
+        {
+            chunkSize = StringTableChunkSize;
+        }
+
+        StringTableChunk *chunk = malloc(chunkSize);
+        assert(chunk);
+
+        chunk->next = Table.chunks;
+        Table.chunks = chunk;
+
+        Table.nextItem = (uint8_t *)&chunk->alignment;
+        Table.chunkEnd = (uint8_t *)chunk + chunkSize;
+    }
+
+    void *item = Table.nextItem;
+    Table.nextItem += size;
+
+    return item;
+}
+
+static bool StringTableIsInSource(const char *text)
+{
+    return Table.sourceData && text >= Table.sourceData && text < Table.sourceData + Table.sourceDataCount;
+}
+
+static void StringTableGrow(void)
+{
+    int32_t oldCapacity = Table.capacity;
+    InternedString **oldSlots = Table.slots;
+
+    Table.capacity *= 2;
+    Table.slots = calloc(Table.capacity, sizeof(InternedString *));
+    assert(Table.slots);
+
+    uint32_t mask = (uint32_t)Table.capacity - 1;
+
+    for (int32_t i = 0; i < oldCapacity; i++)
+    {
+        InternedString *string = oldSlots[i];
+
+        if (!string)
+        {
+            continue;
+        }
+
+        uint32_t slotI = string->hash & mask;
+
+        while (Table.slots[slotI])
+        {
+            slotI = (slotI + 1) & mask;
+        }
+
+        Table.slots[slotI] = string;
+    }
+
+    free(oldSlots);
+}
+
+InternedString *StringTableIntern(const char *text, int32_t textLength)
+{
+    uint32_t hash = StringTableHash(text, textLength);
+    uint32_t mask = (uint32_t)Table.capacity - 1;
+    uint32_t slotI = hash & mask;
+
+    while (Table.slots[slotI])
+    {
+        InternedString *string = Table.slots[slotI];
+
+        if (string->hash == hash && string->textLength == textLength && memcmp(string->text, text, textLength) == 0)
+        {
+            return string;
+        }
+
+        slotI = (slotI + 1) & mask;
+    }
+
+    InternedString *string;
+
+    if (StringTableIsInSource(text))
+    {
+        string = StringTableAllocate(sizeof(InternedString));
+        *string = (InternedString){
+            .text = (char *)text,
+            .textLength = textLength,
+            .hash = hash,
+            .index = Table.count,
+        };
+    }
+    else
+    {
+        string = StringTableAllocate(sizeof(InternedString) + textLength + 1);
+        *string = (InternedString){
+            .text = (char *)(string + 1),
+            .textLength = textLength,
+            .hash = hash,
+            .index = Table.count,
+        };
+
+        memcpy(string->text, text, textLength);
+        string->text[textLength] = '\0';
+    }
+
+    Table.slots[slotI] = string;
+    Table.count += 1;
+
+    // Keep the load factor under 3/4.
+    if (Table.count * 4 >= Table.capacity * 3)
+    {
+        StringTableGrow();
+    }
+
+    return string;
+}
+
+// The source needs to stay alive and unchanged until it's released.
+void StringTableSetSource(const char *data, int64_t dataCount)
+{
+    Table.sourceData = data;
+    Table.sourceDataCount = dataCount;
+}
+
+// Gives every string borrowed from the source it's own storage, after which the source can be freed or overwritten.
+// Strings are updated in place, so anything pointing to them stays valid.
+void StringTableReleaseSource(void)
+{
+    if (!Table.sourceData)
+    {
+        return;
+    }
+
+    for (int32_t i = 0; i < Table.capacity; i++)
+    {
+        InternedString *string = Table.slots[i];
+
+        if (!string || !StringTableIsInSource(string->text))
+        {
+            continue;
+        }
+
+        char *text = StringTableAllocate(string->textLength + 1);
+        memcpy(text, string->text, string->textLength);
+        text[string->textLength] = '\0';
+
+        string->text = text;
+    }
+
+    Table.sourceData = NULL;
+    Table.sourceDataCount = 0;
+}
+
+int32_t StringTableGetCount(void)
+{
+    return Table.count;
+}
+
+InternedStringSizes InternedStringSizesNew(const FontMetrics *metrics)
+{
+    return (InternedStringSizes){
+        .metrics = metrics,
+    };
+}
+
+void InternedStringSizesDelete(InternedStringSizes *sizes)
+{
+    free(sizes->sizes);
+    *sizes = (InternedStringSizes){0};
+}
+
+// Only reads the string and the metrics, so each thread can measure strings into it's own sizes at the same time.
+void InternedStringMeasure(InternedStringSizes *sizes, const InternedString *string, int32_t *width, int32_t *height)
+{
+    if (string->index >= sizes->capacity)
+    {
+        int32_t oldCapacity = sizes->capacity;
+        int32_t capacity = oldCapacity > 0 ? oldCapacity : StringTableInitialCapacity;
+
+        while (capacity <= string->index)
+        {
+            capacity *= 2;
+        }
+
+        sizes->sizes = realloc(sizes->sizes, capacity * sizeof(TextSize));
+        assert(sizes->sizes);
+        sizes->capacity = capacity;
+
+        for (int32_t i = oldCapacity; i < capacity; i++)
+        {
+            sizes->sizes[i].height = -1;
+        }
+    }
+
+    TextSize *size = &sizes->sizes[string->index];
+
+    if (size->height < 0)
+    {
+        FontMetricsGetTextSize(
+            sizes->metrics, string->text, string->textLength, &size->width, &size->height, NULL, NULL);
+    }
+
+    *width = size->width;
+    *height = size->height;
+}
\ No newline at end of file
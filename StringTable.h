@@ -0,0 +1,42 @@
+#pragma once
+
+#include "FontMetrics.h"
+
+#include <inttypes.h>
+
+// Interned strings live until the table is deinitialized, so they can be compared and shared by pointer.
+typedef struct InternedString
+{
+    // Only null terminated once the string has it's own storage, while it's borrowed from the source it isn't.
+    char *text;
+    int32_t textLength;
+    uint32_t hash;
+    // Strings are numbered in the order they're interned, so data about them can be kept in arrays.
+    int32_t index;
+} InternedString;
+
+typedef struct TextSize
+{
+    int32_t width;
+    int32_t height;
+} TextSize;
+
+// Sizes of interned strings measured with one font's metrics. Measuring fills it in, so every thread doing layout
+// keeps it's own, and the strings themselves are never written to once they're interned.
+typedef struct InternedStringSizes
+{
+    const FontMetrics *metrics;
+    // Strings that haven't been measured yet have a negative height.
+    TextSize *sizes;
+    int32_t capacity;
+} InternedStringSizes;
+
+void StringTableInit(void);
+void StringTableDeinit(void);
+InternedString *StringTableIntern(const char *text, int32_t textLength);
+void StringTableSetSource(const char *data, int64_t dataCount);
+void StringTableReleaseSource(void);
+int32_t StringTableGetCount(void);
+InternedStringSizes InternedStringSizesNew(const FontMetrics *metrics);
+void InternedStringSizesDelete(InternedStringSizes *sizes);
+void InternedStringMeasure(InternedStringSizes *sizes, const InternedString *string, int32_t *width, int32_t *height);
\ No newline at end of file
@@ -4,4 +4,8 @@ const int32_t FontAscent = 3;
 const int32_t BlockPaddingX = 4;
 const int32_t BlockPaddingY = 2;
 const float LineWidth = 2;
-const float BorderWidth = 1;
\ No newline at end of file
+const float BorderWidth = 1;
+// Text that would be drawn shorter than this many pixels is replaced by a bar.
+const float TextLodMinPixelHeight = 8;
+// Blocks that would be drawn thinner than this many pixels are drawn without their text or children.
+const float BlockLodMinPixelSize = 2;
\ No newline at end of file
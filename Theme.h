@@ -19,4 +19,6 @@ extern const int32_t FontAscent;
 extern const int32_t BlockPaddingX;
 extern const int32_t BlockPaddingY;
 extern const float LineWidth;
-extern const float BorderWidth;
\ No newline at end of file
+extern const float BorderWidth;
+extern const float TextLodMinPixelHeight;
+extern const float BlockLodMinPixelSize;
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "Tracer.h"
+#include "List.h"
+#include "Profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct TraceEvent
+{
+    const char *name;
+    double time;
+    char phase;
+} TraceEvent;
+
+ListDefine(TraceEvent);
+
+typedef struct Tracer
+{
+    const char *path;
+    List_TraceEvent events;
+    double startTime;
+    bool isEnabled;
+} Tracer;
+
+static Tracer GlobalTracer;
+
+void TracerStart(const char *path)
+{
+    GlobalTracer = (Tracer){
+        .path = path,
+        .events = ListNew_TraceEvent(1024),
+        .startTime = ProfilerGetTime(),
+        .isEnabled = true,
+    };
+}
+
+// Writes out all of the recorded events.
+void TracerStop(void)
+{
+    if (!GlobalTracer.isEnabled)
+    {
+        return;
+    }
+
+    FILE *file = fopen(GlobalTracer.path, "w");
+    if (!file)
+    {
+        printf("Couldn't open file \"%s\"", GlobalTracer.path);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    for (int32_t i = 0; i < GlobalTracer.events.count; i++)
+    {
+        TraceEvent *event = &GlobalTracer.events.data[i];
+
+        // Trace event times are in microseconds.
+        fprintf(file, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1}%s\n", event->name, event->phase,
+            (event->time - GlobalTracer.startTime) * 1000000.0, i < GlobalTracer.events.count - 1 ? "," : "");
+    }
+
+    fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+
+    ListDelete_TraceEvent(&GlobalTracer.events);
+    GlobalTracer = (Tracer){0};
+}
+
+bool TracerIsEnabled(void)
+{
+    return GlobalTracer.isEnabled;
+}
+
+static void TracerAddEvent(const char *name, char phase)
+{
+    TraceEvent event = (TraceEvent){
+        .name = name,
+        .time = ProfilerGetTime(),
+        .phase = phase,
+    };
+
+    ListPush_TraceEvent(&GlobalTracer.events, event);
+}
+
+void TracerBegin(const char *name)
+{
+    if (!GlobalTracer.isEnabled)
+    {
+        return;
+    }
+
+    TracerAddEvent(name, 'B');
+}
+
+void TracerEnd(const char *name)
+{
+    if (!GlobalTracer.isEnabled)
+    {
+        return;
+    }
+
+    TracerAddEvent(name, 'E');
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdbool.h>
+
+// Records nested scopes as Chrome trace events, which can be opened in chrome://tracing or Perfetto.
+// Scopes are only recorded between TracerStart and TracerStop, otherwise beginning and ending them is almost free.
+void TracerStart(const char *path);
+void TracerStop(void);
+bool TracerIsEnabled(void);
+// Names aren't copied or escaped, so they should be string literals.
+void TracerBegin(const char *name);
+void TracerEnd(const char *name);
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Writer.h"
 
+#include <string.h>
+
 Writer WriterNew(void)
 {
     return (Writer){
@@ -23,7 +25,7 @@ void WriterNewline(Writer *writer)
     writer->isAfterNewline = true;
 }
 
-static void WriterWriteInternal(Writer *writer, char *string, bool isIdentifier)
+static void WriterWriteInternal(Writer *writer, char *string, int32_t stringLength, bool isIdentifier)
 {
     if (writer->isAfterNewline)
     {
@@ -40,9 +42,9 @@ static void WriterWriteInternal(Writer *writer, char *string, bool isIdentifier)
         return;
     }
 
-    bool doConvert = isIdentifier && string[0] != '"' && string[0] != '\'';
+    bool doConvert = isIdentifier && stringLength > 0 && string[0] != '"' && string[0] != '\'';
 
-    for (int32_t i = 0; string[i] != '\0'; i++)
+    for (int32_t i = 0; i < stringLength; i++)
     {
         if (string[i] == ' ' && doConvert)
         {
@@ -56,12 +58,13 @@ static void WriterWriteInternal(Writer *writer, char *string, bool isIdentifier)
 
 void WriterWrite(Writer *writer, char *string)
 {
-    WriterWriteInternal(writer, string, false);
+    WriterWriteInternal(writer, string, string ? (int32_t)strlen(string) : 0, false);
 }
 
-void WriterWriteIdentifier(Writer *writer, char *string)
+// Identifiers aren't always null terminated.
+void WriterWriteIdentifier(Writer *writer, char *string, int32_t stringLength)
 {
-    WriterWriteInternal(writer, string, true);
+    WriterWriteInternal(writer, string, stringLength, true);
 }
 
 void WriterWriteLine(Writer *writer, char *string)
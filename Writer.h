@@ -16,7 +16,7 @@ void WriterDelete(Writer *writer);
 void WriterReset(Writer *writer);
 void WriterNewline(Writer *writer);
 void WriterWrite(Writer *writer, char *string);
-void WriterWriteIdentifier(Writer *writer, char *string);
+void WriterWriteIdentifier(Writer *writer, char *string, int32_t stringLength);
 void WriterWriteLine(Writer *writer, char *string);
 void WriterIndent(Writer *writer);
 void WriterUnindent(Writer *writer);
\ No newline at end of file
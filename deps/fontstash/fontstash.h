@@ -107,6 +107,11 @@ FONS_DEF void fonsGetAtlasSize(FONScontext* s, int* width, int* height);
 FONS_DEF int fonsExpandAtlas(FONScontext* s, int width, int height);
 // Resets the whole stash.
 FONS_DEF int fonsResetAtlas(FONScontext* stash, int width, int height);
+// Starts a new frame for stamping when glyphs were last used. Returns how many glyphs were rasterized in the last one.
+FONS_DEF int fonsNextFrame(FONScontext* stash);
+// Evicts glyphs that haven't been used in the given number of frames, and packs the rest back into the atlas.
+// Returns how many glyphs were evicted.
+FONS_DEF int fonsEvictGlyphs(FONScontext* stash, int idleFrames);
 
 // Add fonts
 FONS_DEF int fonsGetFontByName(FONScontext* s, const char* name);
@@ -132,6 +137,11 @@ FONS_DEF float fonsDrawText(FONScontext* s, float x, float y, const char* string
 FONS_DEF float fonsTextBounds(FONScontext* s, float x, float y, const char* string, const char* end, float* bounds);
 FONS_DEF void fonsLineBounds(FONScontext* s, float y, float* miny, float* maxy);
 FONS_DEF void fonsVertMetrics(FONScontext* s, float* ascender, float* descender, float* lineh);
+// Advance of a single codepoint at the current size, rounded like text is laid out. Doesn't add the glyph to the atlas.
+FONS_DEF float fonsCodepointAdvance(FONScontext* s, unsigned int codepoint);
+// First codepoint after the given one that the current font has a glyph for, or 0 when there are none left.
+// Fallback fonts aren't searched.
+FONS_DEF unsigned int fonsNextCodepoint(FONScontext* s, unsigned int codepoint);
 
 // Text iterator
 FONS_DEF int fonsTextIterInit(FONScontext* stash, FONStextIter* iter, float x, float y, const char* str, const char* end);
@@ -163,6 +173,13 @@ FONS_DEF void fonsDrawDebug(FONScontext* s, float x, float y);
 #include FT_ADVANCES_H
 #include <math.h>
 
+#ifdef FONS_FREETYPE_SDF
+#include FT_MODULE_H
+#ifndef FONS_FREETYPE_SDF_SPREAD
+#	define FONS_FREETYPE_SDF_SPREAD 8
+#endif
+#endif
+
 struct FONSttFontImpl {
 	FT_Face font;
 };
@@ -175,6 +192,12 @@ static int fons__tt_init()
 	FT_Error ftError;
 	// FONS_NOTUSED(context);
 	ftError = FT_Init_FreeType(&ftLibrary);
+#ifdef FONS_FREETYPE_SDF
+	if (ftError == 0) {
+		FT_UInt spread = FONS_FREETYPE_SDF_SPREAD;
+		FT_Property_Set(ftLibrary, "sdf", "spread", &spread);
+	}
+#endif
 	return ftError == 0;
 }
 
@@ -205,6 +228,12 @@ static int fons__tt_getGlyphIndex(FONSttFontImpl *font, int codepoint)
 	return FT_Get_Char_Index(font->font, codepoint);
 }
 
+static unsigned int fons__tt_getNextCodepoint(FONSttFontImpl *font, unsigned int codepoint)
+{
+	FT_UInt glyph;
+	return (unsigned int)FT_Get_Next_Char(font->font, codepoint, &glyph);
+}
+
 static int fons__tt_buildGlyphBitmap(FONSttFontImpl *font, int glyph, float size, float scale,
 							  int *advance, int *lsb, int *x0, int *y0, int *x1, int *y1)
 {
@@ -217,7 +246,14 @@ static int fons__tt_buildGlyphBitmap(FONSttFontImpl *font, int glyph, float size
 	if (ftError) return 0;
 	// ftError = FT_Load_Glyph(font->font, glyph, FT_LOAD_RENDER);
 	// ftError = FT_Load_Glyph(font->font, glyph, FT_LOAD_RENDER|FT_LOAD_MONOCHROME|FT_LOAD_TARGET_MONO|FT_LOAD_FORCE_AUTOHINT ); // MG: for disabling aa
+#ifdef FONS_FREETYPE_SDF
+	// Signed distance fields are scaled when drawn, so the outline is used as is, without hinting.
+	ftError = FT_Load_Glyph(font->font, glyph, FT_LOAD_NO_HINTING|FT_LOAD_NO_BITMAP);
+	if (ftError) return 0;
+	ftError = FT_Render_Glyph(font->font->glyph, FT_RENDER_MODE_SDF);
+#else
 	ftError = FT_Load_Glyph(font->font, glyph, FT_LOAD_RENDER|FT_LOAD_FORCE_AUTOHINT); // MG: for disabling aa
+#endif
 	if (ftError) return 0;
 	ftError = FT_Get_Advance(font->font, glyph, FT_LOAD_NO_SCALE, &advFixed);
 	if (ftError) return 0;
@@ -250,6 +286,13 @@ static void fons__tt_renderGlyphBitmap(FONSttFontImpl *font, unsigned char *outp
 	}
 }
 
+static int fons__tt_getGlyphAdvance(FONSttFontImpl *font, int glyph)
+{
+	FT_Fixed advFixed;
+	if (FT_Get_Advance(font->font, glyph, FT_LOAD_NO_SCALE, &advFixed)) return 0;
+	return (int)advFixed;
+}
+
 static int fons__tt_getGlyphKernAdvance(FONSttFontImpl *font, int glyph1, int glyph2)
 {
 	FT_Vector ftKerning;
@@ -303,6 +346,15 @@ static int fons__tt_getGlyphIndex(FONSttFontImpl *font, int codepoint)
 	return stbtt_FindGlyphIndex(&font->font, codepoint);
 }
 
+static unsigned int fons__tt_getNextCodepoint(FONSttFontImpl *font, unsigned int codepoint)
+{
+	// stb_truetype can't walk the character map, so every following codepoint is looked up instead.
+	while (++codepoint <= 0x10FFFF) {
+		if (stbtt_FindGlyphIndex(&font->font, codepoint) != 0) return codepoint;
+	}
+	return 0;
+}
+
 static int fons__tt_buildGlyphBitmap(FONSttFontImpl *font, int glyph, float size, float scale,
 							  int *advance, int *lsb, int *x0, int *y0, int *x1, int *y1)
 {
@@ -318,6 +370,13 @@ static void fons__tt_renderGlyphBitmap(FONSttFontImpl *font, unsigned char *outp
 	stbtt_MakeGlyphBitmap(&font->font, output, outWidth, outHeight, outStride, scaleX, scaleY, glyph);
 }
 
+static int fons__tt_getGlyphAdvance(FONSttFontImpl *font, int glyph)
+{
+	int advance, lsb;
+	stbtt_GetGlyphHMetrics(&font->font, glyph, &advance, &lsb);
+	return advance;
+}
+
 static int fons__tt_getGlyphKernAdvance(FONSttFontImpl *font, int glyph1, int glyph2)
 {
 	return stbtt_GetGlyphKernAdvance(&font->font, glyph1, glyph2);
@@ -379,6 +438,7 @@ struct FONSglyph
 	short size, blur;
 	short x0,y0,x1,y1;
 	short xadv,xoff,yoff;
+	unsigned int lastUsed;
 };
 typedef struct FONSglyph FONSglyph;
 
@@ -446,6 +506,8 @@ struct FONScontext
 	int nstates;
 	void (*handleError)(void* uptr, int error, int val);
 	void* errorUptr;
+	unsigned int frame;
+	int nrasterized;
 };
 
 #ifdef STB_TRUETYPE_IMPLEMENTATION
@@ -1048,8 +1110,10 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	h = fons__hashint(codepoint) & (FONS_HASH_LUT_SIZE-1);
 	i = font->lut[h];
 	while (i != -1) {
-		if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur)
+		if (font->glyphs[i].codepoint == codepoint && font->glyphs[i].size == isize && font->glyphs[i].blur == iblur) {
+			font->glyphs[i].lastUsed = stash->frame;
 			return &font->glyphs[i];
+		}
 		i = font->glyphs[i].next;
 	}
 
@@ -1096,7 +1160,9 @@ static FONSglyph* fons__getGlyph(FONScontext* stash, FONSfont* font, unsigned in
 	glyph->xadv = (short)(scale * advance * 10.0f);
 	glyph->xoff = (short)(x0 - pad);
 	glyph->yoff = (short)(y0 - pad);
+	glyph->lastUsed = stash->frame;
 	glyph->next = 0;
+	stash->nrasterized++;
 
 	// Insert char to hash lookup.
 	glyph->next = font->lut[h];
@@ -1512,6 +1578,57 @@ FONS_DEF float fonsTextBounds(FONScontext* stash,
 	return advance;
 }
 
+FONS_DEF float fonsCodepointAdvance(FONScontext* stash, unsigned int codepoint)
+{
+	FONSstate* state;
+	short isize;
+	FONSfont* font;
+	FONSfont* renderFont;
+	int i, g;
+	float scale;
+	short xadv;
+
+	if (stash == NULL) return 0;
+	state = fons__getState(stash);
+	isize = (short)(state->size*10.0f);
+	if (state->font < 0 || state->font >= stash->nfonts) return 0;
+	font = stash->fonts[state->font];
+	if (font->data == NULL || isize < 2) return 0;
+
+	// Find the glyph the same way as fons__getGlyph(), but only read it's metrics.
+	renderFont = font;
+	g = fons__tt_getGlyphIndex(&font->font, codepoint);
+	if (g == 0) {
+		for (i = 0; i < font->nfallbacks; ++i) {
+			FONSfont* fallbackFont = stash->fonts[font->fallbacks[i]];
+			int fallbackIndex = fons__tt_getGlyphIndex(&fallbackFont->font, codepoint);
+			if (fallbackIndex != 0) {
+				g = fallbackIndex;
+				renderFont = fallbackFont;
+				break;
+			}
+		}
+	}
+	scale = fons__tt_getPixelHeightScale(&renderFont->font, (float)isize/10.0f);
+	xadv = (short)(scale * fons__tt_getGlyphAdvance(&renderFont->font, g) * 10.0f);
+
+	return (float)(int)(xadv / 10.0f + 0.5f);
+}
+
+FONS_DEF unsigned int fonsNextCodepoint(FONScontext* stash, unsigned int codepoint)
+{
+	FONSstate* state;
+	FONSfont* font;
+
+	if (stash == NULL) return 0;
+	state = fons__getState(stash);
+	if (state->font < 0 || state->font >= stash->nfonts) return 0;
+	font = stash->fonts[state->font];
+	if (font->data == NULL) return 0;
+
+	return fons__tt_getNextCodepoint(&font->font, codepoint);
+}
+
 FONS_DEF void fonsVertMetrics(FONScontext* stash,
 					 float* ascender, float* descender, float* lineh)
 {
@@ -1717,4 +1834,83 @@ FONS_DEF int fonsResetAtlas(FONScontext* stash, int width, int height)
 	return 1;
 }
 
+FONS_DEF int fonsNextFrame(FONScontext* stash)
+{
+	int nrasterized;
+	if (stash == NULL) return 0;
+
+	nrasterized = stash->nrasterized;
+	stash->nrasterized = 0;
+	stash->frame++;
+
+	return nrasterized;
+}
+
+FONS_DEF int fonsEvictGlyphs(FONScontext* stash, int idleFrames)
+{
+	int i, j, y, gx, gy, gw, gh, nkept, nevicted = 0;
+	int width, height;
+	unsigned int h;
+	unsigned char* oldData;
+	if (stash == NULL) return 0;
+
+	// Flush pending glyphs.
+	fons__flush(stash);
+
+	width = stash->params.width;
+	height = stash->params.height;
+	oldData = (unsigned char*)malloc(width * height);
+	if (oldData == NULL) return 0;
+	memcpy(oldData, stash->texData, width * height);
+
+	// The skyline packer can't free single rects, so the glyphs that are kept are packed again from scratch.
+	fons__atlasReset(stash->atlas, width, height);
+	memset(stash->texData, 0, width * height);
+	fons__addWhiteRect(stash, 2,2);
+
+	for (i = 0; i < stash->nfonts; i++) {
+		FONSfont* font = stash->fonts[i];
+		for (j = 0; j < FONS_HASH_LUT_SIZE; j++)
+			font->lut[j] = -1;
+
+		nkept = 0;
+		for (j = 0; j < font->nglyphs; j++) {
+			FONSglyph glyph = font->glyphs[j];
+			gw = glyph.x1 - glyph.x0;
+			gh = glyph.y1 - glyph.y0;
+
+			if (stash->frame - glyph.lastUsed > (unsigned int)idleFrames ||
+				fons__atlasAddRect(stash->atlas, gw, gh, &gx, &gy) == 0) {
+				nevicted++;
+				continue;
+			}
+
+			// Move the glyph's bitmap instead of rasterizing it again.
+			for (y = 0; y < gh; y++)
+				memcpy(&stash->texData[gx + (gy + y) * width], &oldData[glyph.x0 + (glyph.y0 + y) * width], gw);
+
+			glyph.x0 = (short)gx;
+			glyph.y0 = (short)gy;
+			glyph.x1 = (short)(gx + gw);
+			glyph.y1 = (short)(gy + gh);
+
+			h = fons__hashint(glyph.codepoint) & (FONS_HASH_LUT_SIZE-1);
+			glyph.next = font->lut[h];
+			font->lut[h] = nkept;
+			font->glyphs[nkept++] = glyph;
+		}
+		font->nglyphs = nkept;
+	}
+
+	free(oldData);
+
+	// The whole atlas has moved around.
+	stash->dirtyRect[0] = 0;
+	stash->dirtyRect[1] = 0;
+	stash->dirtyRect[2] = width;
+	stash->dirtyRect[3] = height;
+
+	return nevicted;
+}
+
 #endif // FONTSTASH_IMPLEMENTATION